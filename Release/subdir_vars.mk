@@ -9,31 +9,97 @@ CMD_SRCS += \
 C_SRCS += \
 ../WS2812B_Strip.c \
 ../main.c \
-../patterns.c 
+../patterns.c \
+../effects.c \
+../audio.c \
+../scheduler.c \
+../sync.c \
+../colormath.c \
+../ramcheck.c \
+../matrix.c \
+../ir.c \
+../animation.c \
+../dco.c \
+../i2c.c 
 
 OBJS += \
 ./WS2812B_Strip.obj \
 ./main.obj \
-./patterns.obj 
+./patterns.obj \
+./effects.obj \
+./audio.obj \
+./scheduler.obj \
+./sync.obj \
+./colormath.obj \
+./ramcheck.obj \
+./matrix.obj \
+./ir.obj \
+./animation.obj \
+./dco.obj \
+./i2c.obj 
 
 C_DEPS += \
 ./WS2812B_Strip.pp \
 ./main.pp \
-./patterns.pp 
+./patterns.pp \
+./effects.pp \
+./audio.pp \
+./scheduler.pp \
+./sync.pp \
+./colormath.pp \
+./ramcheck.pp \
+./matrix.pp \
+./ir.pp \
+./animation.pp \
+./dco.pp \
+./i2c.pp 
 
 C_DEPS__QUOTED += \
 "WS2812B_Strip.pp" \
 "main.pp" \
-"patterns.pp" 
+"patterns.pp" \
+"effects.pp" \
+"audio.pp" \
+"scheduler.pp" \
+"sync.pp" \
+"colormath.pp" \
+"ramcheck.pp" \
+"matrix.pp" \
+"ir.pp" \
+"animation.pp" \
+"dco.pp" \
+"i2c.pp" 
 
 OBJS__QUOTED += \
 "WS2812B_Strip.obj" \
 "main.obj" \
-"patterns.obj" 
+"patterns.obj" \
+"effects.obj" \
+"audio.obj" \
+"scheduler.obj" \
+"sync.obj" \
+"colormath.obj" \
+"ramcheck.obj" \
+"matrix.obj" \
+"ir.obj" \
+"animation.obj" \
+"dco.obj" \
+"i2c.obj" 
 
 C_SRCS__QUOTED += \
 "../WS2812B_Strip.c" \
 "../main.c" \
-"../patterns.c" 
+"../patterns.c" \
+"../effects.c" \
+"../audio.c" \
+"../scheduler.c" \
+"../sync.c" \
+"../colormath.c" \
+"../ramcheck.c" \
+"../matrix.c" \
+"../ir.c" \
+"../animation.c" \
+"../dco.c" \
+"../i2c.c" 
 
 
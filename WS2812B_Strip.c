@@ -8,35 +8,114 @@
 #include <msp430f2272.h>
 #include "WS2812B_Strip.h"
 #include "main.h"
+#include "ir.h"
+
+static void transmit(const uint8_t *buffer, uint16_t numberOfBytes, uint16_t startByte);
+
+// Cycles the code between two port writes takes on the F2272, for the host
+// to charge (host/msp430f2272.h), where C code is otherwise free.
+#ifndef CODE_CYCLES
+#define CODE_CYCLES(cycles)
+#endif
+
+// Back to 'start' when 'ptr' gets to 'end'.  6 cycles either way: cmp and
+// jne, then the mov and a jmp over the nops, or the three nops.
+#define transmitWrap(ptr, start, end)                                          \
+  {                                                                            \
+    CODE_CYCLES(3);                                                            \
+    if ((ptr) == (end))                                                        \
+    {                                                                          \
+      (ptr) = (start);                                                         \
+      CODE_CYCLES(3);                                                          \
+    }                                                                          \
+    else                                                                       \
+    {                                                                          \
+      _no_operation();                                                         \
+      _no_operation();                                                         \
+      _no_operation();                                                         \
+    }                                                                          \
+  }
 
 // "Constructor"
 void create(struct WS2812B_Strip *strip, const uint16_t numberOfPixels)
 {
   strip->numberOfPixels = numberOfPixels;
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_SINGLE
+  strip->numberOfBytes = 3 * numberOfPixels;
+#elif FRAMEBUFFER_MODE == FRAMEBUFFER_DOUBLE
   strip->numberOfBytes = 3 * numberOfPixels;
+  strip->pixels = strip->buffers[0];
+  strip->front  = strip->buffers[1];
+#else // FRAMEBUFFER_HALF
+  strip->numberOfBytes = 3 * ((numberOfPixels + 1) >> 1);
+  strip->pixels = strip->backBuffer;
+  strip->front  = strip->frontBuffer;
+#endif
   strip->brightness = 0;
+  strip->ringOffset = 0;
   strip->inShow = false;
   strip->inInterrupt = false;
   strip->breakFromPattern = false;
 
+  strip->frame.deadline = 0;
+  strip->frame.period = 0;
+  strip->frame.framesShown = 0;
+  strip->frame.framesDropped = 0;
+  strip->frame.deadlinesMissed = 0;
+  strip->frame.step = 0;
+  strip->frame.syncTime = 0;
+  strip->frame.syncStep = 0;
+  strip->frame.syncPending = false;
+
   // Blank our pixel memory array.
   uint16_t i;
   for(i = 0; i < strip->numberOfBytes; i++)
   {
 	strip->pixels[i] = 0;
   }
+#if FRAMEBUFFER_MODE != FRAMEBUFFER_SINGLE
+  for(i = 0; i < 3 * numberOfPixels; i++)
+  {
+	strip->front[i] = 0;
+  }
+#endif
 }
 
 
 // Sets the data for out entire pixel array to zeros (blank.)
 void clear(struct WS2812B_Strip *strip)
 {
-  // Clear our pixel array.
+  strip->ringOffset = 0;
+  fillPixels(strip, 0, strip->numberOfPixels, 0);
+}
+
+
+// Turns the LEDs off right now.  Safe to call from an ISR: with a front
+// buffer only the front is blanked, so a pattern halfway through drawing
+// the back buffer is left alone.
+void blank(struct WS2812B_Strip *strip)
+{
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_SINGLE
+  clear(strip);
+  show(strip);
+#else
+  uint16_t interruptsOn = __get_SR_register() & GIE;
   uint16_t i;
-  for(i = 0; i < strip->numberOfBytes; i++)
+
+  __bic_SR_register(GIE);
+  if (strip->inShow == false)
   {
-	strip->pixels[i] = 0;
+    strip->inShow = true;
+    for(i = 0; i < 3 * strip->numberOfPixels; i++)
+    {
+      strip->front[i] = 0;
+    }
+    transmit(strip->front, 3 * strip->numberOfPixels, 0);
+    strip->inShow = false;
   }
+  if (interruptsOn)
+    __bis_SR_register(GIE);
+#endif
 }
 
 
@@ -69,34 +148,117 @@ void clear(struct WS2812B_Strip *strip)
 //
 //
 // PSUEDO:
-//  1. Turn off Interrupts!  Time critical.
-//  2. 100us pause to reset the data cycle.
-//  3. get end address of pixels[] (pixels + numberOfBytes)
-//  4. Get pointer for each byte to be written (bit by bit).
-//  5. Write each byte (bit by bit) for "numberOfBytes".
-//  6. increment pointer.
-//  7. All Data written. Turn on interrups back on.
+//  0. Don't blank out an IR frame halfway through, see irWait().
+//  1. Turn off Interrupts!  Time critical.  Take the inShow lock with them
+//     off, so an ISR can't get in between testing and setting it.
+//  2. Front/back buffers: swap them, the finished frame becomes the front.
+//     (Half resolution: expand the back buffer into the front.)
+//  3. Transmit the front buffer, as a ring starting at strip->ringOffset.
+//  4. Front/back buffers: copy the front into the new back buffer, so
+//     patterns can keep drawing on top of the last frame.
+//  5. Release the lock, interrupts back to how we found them.
 //----------------------------------------------------------------------------
 void show(struct WS2812B_Strip *strip)
 {
-  if (strip->inShow == true)
-	return;
+  uint16_t interruptsOn = __get_SR_register() & GIE;
+  uint16_t ringStart = (strip->ringOffset << 1) + strip->ringOffset;
+
+  //  0. Don't blank out an IR frame halfway through.
+  if (interruptsOn)
+    irWait(strip);
 
   //  1. Turn off Interrupts!  Time critical.
   // DISABLE global interrupts.  "Bit Clear Status Register"
   __bic_SR_register(GIE);
+  if (strip->inShow == true)
+  {
+    if (interruptsOn)
+      __bis_SR_register(GIE);
+    return;
+  }
   strip->inShow = true;
 
-  //  2. Turn output low for 50us. (800 cycles @16MHz ~= 50us).
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_SINGLE
+  //  3. Transmit the front buffer, as a ring starting at strip->ringOffset.
+  transmit(strip->pixels, strip->numberOfBytes, ringStart);
+#elif FRAMEBUFFER_MODE == FRAMEBUFFER_DOUBLE
+  //  2. Front/back buffers: swap them, the finished frame becomes the front.
+  uint8_t *finished = strip->pixels;
+  strip->pixels = strip->front;
+  strip->front = finished;
+
+  //  3. Transmit the front buffer, as a ring starting at strip->ringOffset.
+  transmit(strip->front, strip->numberOfBytes, ringStart);
+#else // FRAMEBUFFER_HALF
+  //  2. (Half resolution: expand the back buffer into the front.)
+  uint8_t *src = strip->pixels;
+  uint8_t *dst = strip->front;
+  uint16_t i;
+  for (i = strip->numberOfPixels >> 1; i != 0; i--)
+  {
+    dst[0] = dst[3] = src[0];
+    dst[1] = dst[4] = src[1];
+    dst[2] = dst[5] = src[2];
+    dst += 6;
+    src += 3;
+  }
+  if (strip->numberOfPixels & 0x01)
+  {
+    dst[0] = src[0];
+    dst[1] = src[1];
+    dst[2] = src[2];
+  }
+
+  //  3. Transmit the front buffer, as a ring starting at strip->ringOffset.
+  transmit(strip->front, 3 * strip->numberOfPixels, ringStart);
+#endif
+
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_DOUBLE
+  //  4. Front/back buffers: copy the front into the new back buffer, still
+  //     with interrupts off or blank() could zero the front halfway through.
+  const uint8_t *from = strip->front;
+  uint8_t *to = strip->pixels;
+  uint16_t i;
+  for (i = strip->numberOfBytes; i != 0; i--)
+  {
+    *to++ = *from++;
+  }
+#endif
+
+  //  5. Release the lock, interrupts back to how we found them.
+  strip->inShow = false;
+  if (interruptsOn)
+    __bis_SR_register(GIE);    // Enable global interrupts.  "Bit Set Status Register"
+}
+
+
+// Bit bangs 'numberOfBytes' bytes of 'buffer' out of SERIAL_OUTPUT_PIN,
+// starting at 'startByte' and wrapping round to the start of 'buffer'.
+// Interrupts MUST already be off.  See the timing notes above show().
+//
+// The wrap is checked once a byte, in the BIT0 slot, and costs the same 6
+// cycles whether it wraps or not (transmitWrap()), so the byte it wraps at
+// goes out exactly like every other:
+//  - a last One checks while it is high, where the nops used to be
+//    (2 cycles longer high, ~850ns, still inside 800ns +/- 150ns).
+//  - a last Zero can't stay high any longer, so it checks once it is low
+//    (~1475ns low, the LEDs only take a low of 50us as a reset.)
+//
+// PSUEDO:
+//  1. 50us pause to reset the data cycle.
+//  2. Write each byte (bit by bit) for "numberOfBytes", from 'startByte'.
+//  3. increment pointer, back to the start of 'buffer' at its end.
+static void transmit(const uint8_t *buffer, uint16_t numberOfBytes, uint16_t startByte)
+{
+  const uint8_t *ptr = buffer + startByte;
+  const uint8_t *end = buffer + numberOfBytes;
+  uint16_t bytesLeft = numberOfBytes;
+
+  //  1. Turn output low for 50us. (800 cycles @16MHz ~= 50us).
   SERIAL_OUTPUT_PORT &= ~SERIAL_OUTPUT_PIN;
   __delay_cycles(800);
 
-  //  3. get end address of pixels[] (pixels + numberOfBytes)
-  //  4. Get pointer for each byte to be written (bit by bit).
-  uint16_t  bytesLeft = strip->numberOfBytes;
-  uint8_t *ptr = strip->pixels;                      // Pointer to the current byte we are writing.
-
-  //  5. Write each byte (bit by bit) for "numberOfBytes".
+  //  2. Write each byte (bit by bit) for "numberOfBytes", from 'startByte'.
   while(bytesLeft != 0)  // 2 cycles.
   {
     if (*ptr & BIT7)
@@ -140,10 +302,8 @@ void show(struct WS2812B_Strip *strip)
       SERIAL_OUTPUT_PORT |= SERIAL_OUTPUT_PIN;
       bytesLeft--;
       ptr++;
-      _no_operation();
-      _no_operation();
-      _no_operation();
-      _no_operation();
+      //  3. increment pointer, back to the start of 'buffer' at its end.
+      transmitWrap(ptr, buffer, end);
 
       SERIAL_OUTPUT_PORT &= ~SERIAL_OUTPUT_PIN;
     }
@@ -155,14 +315,13 @@ void show(struct WS2812B_Strip *strip)
       ptr++;
 
       SERIAL_OUTPUT_PORT &= ~SERIAL_OUTPUT_PIN;
+      //  3. increment pointer, back to the start of 'buffer' at its end.
+      transmitWrap(ptr, buffer, end);
     }
 
   }
 
 
-  //  7. All Data written. Turn on interrups back on.
-  __bis_SR_register(GIE);    // Enable global interrupts.  "Bit Set Status Register"
-  strip->inShow = false;
 }
 
 inline void writeOne(void)
@@ -203,6 +362,9 @@ void setPixelColor(struct WS2812B_Strip *strip, uint16_t pixelIndex, uint32_t co
       g = (g * strip->brightness) >> 8;
       b = (b * strip->brightness) >> 8;
     }
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_HALF
+    pixelIndex >>= 1;  // Neighbouring pixels share a color.
+#endif
     uint8_t *p = &strip->pixels[pixelIndex * 3];
     p[1] = r;
     p[0] = g;
@@ -212,6 +374,284 @@ void setPixelColor(struct WS2812B_Strip *strip, uint16_t pixelIndex, uint32_t co
 
 
 
+// Rotate what is shown by 'amount' pixels towards pixel 0 (pixel 'amount'
+// is shown on pixel 0 after the next show()), without moving any pixel
+// data: show() just starts transmitting further round the buffer.  Use
+// numberOfPixels - amount to rotate the other way.  The pixels that come
+// round from the other end can then be redrawn through ringIndex().
+//
+// Left out of FRAMEBUFFER_HALF builds, so using it there doesn't link:
+// the back buffer holds pixel pairs, an odd rotation would split them and
+// a ringIndex() write would land on two pixels shown apart.  Patterns
+// redraw the whole strip there instead (see rainbow().)
+#if FRAMEBUFFER_MODE != FRAMEBUFFER_HALF
+void rotatePixels(struct WS2812B_Strip *strip, uint16_t amount)
+{
+  if (strip->numberOfPixels == 0)
+    return;
+  while (amount >= strip->numberOfPixels)
+    amount -= strip->numberOfPixels;
+
+  strip->ringOffset += amount;
+  if (strip->ringOffset >= strip->numberOfPixels)
+    strip->ringOffset -= strip->numberOfPixels;
+}
+
+
+// Buffer index that is shown on pixel 'pixelIndex' after rotatePixels().
+// setPixelColor() and the range functions take buffer indexes.
+uint16_t ringIndex(const struct WS2812B_Strip *strip, uint16_t pixelIndex)
+{
+  pixelIndex += strip->ringOffset;
+  if (pixelIndex >= strip->numberOfPixels)
+    pixelIndex -= strip->numberOfPixels;
+  return pixelIndex;
+}
+#endif
+
+
+
+//******************************************************************************
+//   RANGE PRIMITIVES
+//
+// setPixelColor() does a bounds check, three brightness multiplies (library
+// calls, there is no hardware multiplier) and a pixelIndex * 3 for every
+// pixel.  These do the bounds check and the multiplies once per call and
+// then just store, so writing the same color (or the same few colors) over
+// a run of pixels costs:
+//
+//  fillPixels():         3 word stores per 2 pixels (fillPixelsStored()
+//                        skips the multiplies too.)
+//  fillPixelsStrided():  3 byte stores and a shift and add per pixel.
+//  blitPixels():         setPixelColor() for the first period, then a 3
+//                        byte copy per pixel (words for an even period.)
+//
+// The saving is per pixel, so it grows with the strip.  Half resolution
+// buffers work in pixel pairs, same as setPixelColor().
+//******************************************************************************
+
+// &strip->pixels[] of 'pixelIndex', * 3 done as a shift and add.
+static uint8_t *pixelAddress(struct WS2812B_Strip *strip, uint16_t pixelIndex)
+{
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_HALF
+  pixelIndex >>= 1;  // Neighbouring pixels share a color.
+#endif
+  return &strip->pixels[(pixelIndex << 1) + pixelIndex];
+}
+
+
+// 'color' with strip->brightness applied, as fillPixelsStored() wants it.
+uint32_t storedColor(const struct WS2812B_Strip *strip, uint32_t color)
+{
+  uint8_t r = (uint8_t)(color >> 16);
+  uint8_t g = (uint8_t)(color >>  8);
+  uint8_t b = (uint8_t)(color);
+
+  if(strip->brightness)
+  { // See notes in setBrightness()
+    r = ((uint16_t)r * strip->brightness) >> 8;
+    g = ((uint16_t)g * strip->brightness) >> 8;
+    b = ((uint16_t)b * strip->brightness) >> 8;
+  }
+  return ((uint32_t)r << 16) | ((uint16_t)g << 8) | b;
+}
+
+
+// Fill 'count' pixels from 'first' with one color.
+void fillPixels(struct WS2812B_Strip *strip, uint16_t first, uint16_t count, uint32_t color)
+{
+  fillPixelsStored(strip, first, count, storedColor(strip, color));
+}
+
+
+// fillPixels() with a color from storedColor(), so the brightness
+// multiplies can be done once for many fills.
+//
+// PSUEDO:
+//  1. Clip to the strip.
+//  2. Odd address: one pixel a byte at a time to get word aligned.
+//  3. Two pixels (g r b g r b) as three word stores.
+//  4. Last odd pixel a byte at a time.
+void fillPixelsStored(struct WS2812B_Strip *strip, uint16_t first, uint16_t count, uint32_t stored)
+{
+  uint8_t r = (uint8_t)(stored >> 16);
+  uint8_t g = (uint8_t)(stored >>  8);
+  uint8_t b = (uint8_t)(stored);
+  uint16_t *word;
+  uint8_t *p;
+
+  //  1. Clip to the strip.
+  if (first >= strip->numberOfPixels)
+    return;
+  if (count > strip->numberOfPixels - first)
+    count = strip->numberOfPixels - first;
+  if (count == 0)
+    return;
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_HALF
+  count = ((first + count - 1) >> 1) - (first >> 1) + 1;
+#endif
+  p = pixelAddress(strip, first);
+
+  //  2. Odd address: one pixel a byte at a time to get word aligned.
+  if ((uint16_t)p & 0x01)
+  {
+    p[0] = g;
+    p[1] = r;
+    p[2] = b;
+    p += 3;
+    count--;
+  }
+
+  //  3. Two pixels (g r b g r b) as three word stores.  Little endian.
+  word = (uint16_t *)p;
+  for (; count >= 2; count -= 2)
+  {
+    word[0] = ((uint16_t)r << 8) | g;
+    word[1] = ((uint16_t)g << 8) | b;
+    word[2] = ((uint16_t)b << 8) | r;
+    word += 3;
+  }
+
+  //  4. Last odd pixel a byte at a time.
+  if (count)
+  {
+    p = (uint8_t *)word;
+    p[0] = g;
+    p[1] = r;
+    p[2] = b;
+  }
+}
+
+
+// Set every 'stride'th pixel from 'first' to the end of the strip.
+void fillPixelsStrided(struct WS2812B_Strip *strip, uint16_t first, uint16_t stride, uint32_t color)
+{
+  uint8_t r = (uint8_t)(color >> 16);
+  uint8_t g = (uint8_t)(color >>  8);
+  uint8_t b = (uint8_t)(color);
+  uint8_t *p;
+
+  if (stride == 0)
+    return;
+  if(strip->brightness)
+  { // See notes in setBrightness()
+    r = ((uint16_t)r * strip->brightness) >> 8;
+    g = ((uint16_t)g * strip->brightness) >> 8;
+    b = ((uint16_t)b * strip->brightness) >> 8;
+  }
+
+  for (; first < strip->numberOfPixels; first += stride)
+  {
+    p = pixelAddress(strip, first);
+    p[0] = g;
+    p[1] = r;
+    p[2] = b;
+  }
+}
+
+
+// Copy 'count' pixels from 'from' to 'to', as stored (brightness already
+// applied.)  The ranges may overlap, like memmove().
+void copyPixels(struct WS2812B_Strip *strip, uint16_t to, uint16_t from, uint16_t count)
+{
+  uint16_t bytes;
+  const uint8_t *src;
+  uint8_t *dst;
+
+  if ((to >= strip->numberOfPixels) || (from >= strip->numberOfPixels))
+    return;
+  if (count > strip->numberOfPixels - to)
+    count = strip->numberOfPixels - to;
+  if (count > strip->numberOfPixels - from)
+    count = strip->numberOfPixels - from;
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_HALF
+  count = (count + 1) >> 1;
+#endif
+
+  bytes = (count << 1) + count;
+  src = pixelAddress(strip, from);
+  dst = pixelAddress(strip, to);
+  if (dst < src)
+  {
+    for (; bytes != 0; bytes--)
+      *dst++ = *src++;
+  }
+  else if (dst > src)
+  {
+    src += bytes;
+    dst += bytes;
+    for (; bytes != 0; bytes--)
+      *--dst = *--src;
+  }
+}
+
+
+// Repeat 'colors' (patternLength of them) over 'count' pixels from 'first'.
+//
+// PSUEDO:
+//  1. Write the first period with setPixelColor().
+//  2. Copy forwards from one period back.  The source runs into bytes this
+//     same loop has just written, so the period repeats to the end.  An
+//     even period (in bytes) keeps source and destination on the same
+//     alignment, so after one odd byte that is a word at a time.
+void blitPixels(struct WS2812B_Strip *strip, uint16_t first, uint16_t count, const uint32_t *colors, uint8_t patternLength)
+{
+  uint16_t i;
+
+  if ((first >= strip->numberOfPixels) || (patternLength == 0))
+    return;
+  if (count > strip->numberOfPixels - first)
+    count = strip->numberOfPixels - first;
+
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_HALF
+  // Pixel pairs break the byte period, just set each one.
+  uint8_t k = 0;
+  for (i = 0; i < count; i++)
+  {
+    setPixelColor(strip, first + i, colors[k]);
+    if (++k == patternLength)
+      k = 0;
+  }
+#else
+  //  1. Write the first period with setPixelColor().
+  for (i = 0; (i < patternLength) && (i < count); i++)
+  {
+    setPixelColor(strip, first + i, colors[i]);
+  }
+  if (count <= patternLength)
+    return;
+
+  //  2. Copy forwards from one period back.
+  uint16_t bytes;
+  const uint8_t *src;
+  uint8_t *dst;
+
+  bytes = ((count - patternLength) << 1) + (count - patternLength);
+  src = pixelAddress(strip, first);
+  dst = pixelAddress(strip, first + patternLength);
+  if ((patternLength & 0x01) == 0)
+  {
+    const uint16_t *srcWord;
+    uint16_t *dstWord;
+
+    if ((uint16_t)dst & 0x01)
+    {
+      *dst++ = *src++;
+      bytes--;
+    }
+    srcWord = (const uint16_t *)src;
+    dstWord = (uint16_t *)dst;
+    for (; bytes >= 2; bytes -= 2)
+      *dstWord++ = *srcWord++;
+    src = (const uint8_t *)srcWord;
+    dst = (uint8_t *)dstWord;
+  }
+  for (; bytes != 0; bytes--)
+    *dst++ = *src++;
+#endif
+}
+
+
 // Adjust output brightness; 0=darkest (off), 255=brightest.  This does
 // NOT immediately affect what's currently displayed on the LEDs.  The
 // next call to show() will refresh the LEDs at this level.  However,
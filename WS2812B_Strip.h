@@ -11,17 +11,32 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "main.h"
+#include "scheduler.h"
 
 struct WS2812B_Strip {
     uint16_t numberOfPixels;   // Number of RGB LEDs in strip
     uint16_t numberOfBytes;    // Size of 'pixels' buffer below
 
     uint8_t brightness;    // Brightness level (0-255, off - fully on)
+    uint16_t ringOffset;   // show() starts at this pixel and wraps, see rotatePixels()
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_SINGLE
     uint8_t pixels[3 * NUMBER_OF_PIXELS];       // Holds LED color values (3 bytes each)
+#else
+    uint8_t *pixels;       // Back buffer, patterns draw here (3 bytes each)
+    uint8_t *front;        // Front buffer, show() transmits this one
+#endif
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_DOUBLE
+    uint8_t buffers[2][3 * NUMBER_OF_PIXELS];
+#elif FRAMEBUFFER_MODE == FRAMEBUFFER_HALF
+    uint8_t frontBuffer[3 * NUMBER_OF_PIXELS];
+    uint8_t backBuffer[3 * ((NUMBER_OF_PIXELS + 1) / 2)];
+#endif
 
     bool inShow;
     bool inInterrupt;
     bool breakFromPattern;
+
+    struct FrameScheduler frame;  // Frame pacing and stats, see scheduler.c
 };
 
 void create(struct WS2812B_Strip *strip, const uint16_t numberOfPixels);
@@ -31,7 +46,21 @@ void inline writeOne(void);
 void inline writeZero(void);
 
 void clear(struct WS2812B_Strip *strip);
+void blank(struct WS2812B_Strip *strip);
 void setPixelColor(struct WS2812B_Strip *strip, uint16_t pixelIndex, uint32_t color);
 void setBrightness(struct WS2812B_Strip *strip, uint8_t brightness);
+#if FRAMEBUFFER_MODE != FRAMEBUFFER_HALF
+// Not in half resolution, see rotatePixels().
+void rotatePixels(struct WS2812B_Strip *strip, uint16_t amount);
+uint16_t ringIndex(const struct WS2812B_Strip *strip, uint16_t pixelIndex);
+#endif
+
+// Range primitives, see WS2812B_Strip.c
+void fillPixels(struct WS2812B_Strip *strip, uint16_t first, uint16_t count, uint32_t color);
+uint32_t storedColor(const struct WS2812B_Strip *strip, uint32_t color);
+void fillPixelsStored(struct WS2812B_Strip *strip, uint16_t first, uint16_t count, uint32_t stored);
+void fillPixelsStrided(struct WS2812B_Strip *strip, uint16_t first, uint16_t stride, uint32_t color);
+void copyPixels(struct WS2812B_Strip *strip, uint16_t to, uint16_t from, uint16_t count);
+void blitPixels(struct WS2812B_Strip *strip, uint16_t first, uint16_t count, const uint32_t *colors, uint8_t patternLength);
 
 #endif // WS2812B_STRIP_H_
@@ -0,0 +1,79 @@
+/*
+ * animation.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * Time based animation.  Instead of counting loop iterations a pattern
+ * asks where it should be now, from the timebase:
+ *
+ *   phase = (now - start) * rate      rate = 2^32 / duration
+ *
+ * The phase is a 32-bit accumulator that wraps once per cycle, so the top
+ * 16 bits are the position through the current cycle.  It only depends on
+ * the time since animationBegin(), not on how many frames were drawn, so
+ * the animation runs at the same speed at any frame rate and a slow frame
+ * just skips ahead.  The one divide is in animationBegin(); each frame is
+ * one 32-bit multiply, nothing per pixel.  rate is rounded down, which is
+ * less than one tick per cycle.
+ */
+
+#include "animation.h"
+#include "scheduler.h"
+
+
+// Start a cycle 'durationMs' long from now.
+void animationBegin(struct Animation *animation, const uint32_t durationMs)
+{
+  animation->start = timebaseNow();
+  animation->duration = durationMs * TIMEBASE_TICKS_PER_MS;
+  if (animation->duration == 0)
+    animation->duration = 1;
+  animation->rate = 0xFFFFFFFF / animation->duration;
+}
+
+
+// Start the next cycle of a sequence where this one ended, not from now,
+// so however late we notice the end the rest of the sequence stays on time.
+void animationNext(struct Animation *animation, const uint32_t durationMs)
+{
+  uint32_t end = animationEnd(animation);
+
+  animationBegin(animation, durationMs);
+  animation->start = end;
+}
+
+
+// Timebase tick the first cycle ends at, for delayUntil().
+uint32_t animationEnd(const struct Animation *animation)
+{
+  return animation->start + animation->duration;
+}
+
+
+// Position through the current cycle, 0 - 65535, wrapping round for
+// repeating animations.
+uint16_t animationPhase(const struct Animation *animation)
+{
+  uint32_t phase = (timebaseNow() - animation->start) * animation->rate;
+  return (uint16_t)(phase >> 16);
+}
+
+
+// Position through the first cycle, 0 - 65535, staying at 65535 once it
+// is over.  For one shot animations.
+uint16_t animationProgress(const struct Animation *animation)
+{
+  uint32_t elapsed = timebaseNow() - animation->start;
+
+  if (elapsed >= animation->duration)
+    return 0xFFFF;
+  return (uint16_t)((elapsed * animation->rate) >> 16);
+}
+
+
+// Has the first cycle finished?
+bool animationDone(const struct Animation *animation)
+{
+  return (timebaseNow() - animation->start) >= animation->duration;
+}
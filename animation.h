@@ -0,0 +1,32 @@
+/*
+ * animation.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ */
+
+#ifndef ANIMATION_H_
+#define ANIMATION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// How often time based patterns redraw.  Their speed does not depend on
+// it, only how smooth they look.
+#define ANIMATION_FRAME_MS  10
+
+// One animation cycle of 'duration', timed on the timebase.
+struct Animation {
+  uint32_t start;     // Timebase tick the cycle started at.
+  uint32_t duration;  // Timebase ticks per cycle.
+  uint32_t rate;      // Phase per tick, 2^32 / duration.
+};
+
+void animationBegin(struct Animation *animation, const uint32_t durationMs);
+void animationNext(struct Animation *animation, const uint32_t durationMs);
+uint32_t animationEnd(const struct Animation *animation);
+uint16_t animationPhase(const struct Animation *animation);
+uint16_t animationProgress(const struct Animation *animation);
+bool animationDone(const struct Animation *animation);
+
+#endif /* ANIMATION_H_ */
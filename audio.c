@@ -0,0 +1,279 @@
+/*
+ * audio.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * Audio reactive mode.  A microphone on A0 is sampled at AUDIO_SAMPLE_RATE
+ * and three frequency bands are measured with Goertzel filters.
+ *
+ * SAMPLING:
+ *   Timer_A runs in up mode at the sample rate and OUT1 (set/reset) triggers
+ *   the ADC10.  The ADC10 DTC writes each result straight into audioBuffer[]
+ *   in continuous two-block mode, so audioBuffer[] is a hardware ring of two
+ *   AUDIO_BLOCK_SIZE halves.  None of this needs the CPU, so sampling keeps
+ *   going while show() has interrupts off.  The ADC10 interrupt only tells us
+ *   which half just filled.  A show() longer than one block (8ms, ~250
+ *   pixels) drops a block and bumps audioOverruns.
+ *
+ * ANALYSIS:
+ *   No hardware multiplier, so the Goertzel coefficient multiply is a 12 step
+ *   shift and add (multiplyQ12).  32 samples x 3 bands ~= 14000 cycles, just
+ *   under 1ms of the 8ms between blocks.
+ *
+ *   audioAnalyze() only touches the samples it is given, no registers, so
+ *   host/test_audio.c can feed it WAV files and check the bands.
+ */
+
+#include <msp430f2272.h>
+#include "audio.h"
+#include "colormath.h"
+#include "patterns.h"
+#include "ir.h"
+#include "i2c.h"
+
+// Hardware ring buffer, filled by the ADC10 DTC.
+static uint16_t audioBuffer[2 * AUDIO_BLOCK_SIZE];
+
+// Half of audioBuffer[] that is ready to analyze, 0 if none.
+static const uint16_t * volatile audioReadyBlock;
+
+uint8_t audioLevel[NUMBER_OF_AUDIO_BANDS];
+volatile uint16_t audioOverruns;
+
+// 2cos(2 * pi * k / AUDIO_BLOCK_SIZE) in Q12 for each band.
+static const int16_t goertzelCoefficient[NUMBER_OF_AUDIO_BANDS] = {
+   8035,  // k = 1   1.9616
+   5793,  // k = 4   1.4142
+  -5793   // k = 12 -1.4142
+};
+
+// Goertzel state.
+static int32_t goertzelS1, goertzelS2;
+
+static int32_t multiplyQ12(int32_t x, int16_t coefficient);
+
+//******************************************************************************
+//******************************************************************************
+//  PATTERNS
+//******************************************************************************
+//******************************************************************************
+
+
+// Pulse the whole strip to the music: bass = red, mid = green, treble = blue.
+//
+// PSUEDO:
+//  1. Start sampling.
+//  2. Sleep until the DTC has filled the next block.
+//  3. Measure the bands.
+//  4. Show the bands.
+//  5. Stop sampling.
+void audioPulse(struct WS2812B_Strip *strip)
+{
+  uint16_t j;
+  const uint16_t *block;
+
+  clear(strip);
+  show(strip);
+
+  //  1. Start sampling.
+  audioStart();
+
+  for (j = 0; j < 256; j++)
+  {
+    //  2. Sleep until the DTC has filled the next block.
+    __bic_SR_register(GIE);
+    while ((audioReadyBlock == 0) && (strip->breakFromPattern == false))
+    {
+      __bis_SR_register(LPM0_bits | GIE);  // ADC10 ISR wakes us.
+      __bic_SR_register(GIE);
+    }
+    block = audioReadyBlock;
+    audioReadyBlock = 0;
+    __bis_SR_register(GIE);
+
+    irPoll(strip);
+    i2cPoll(strip);
+
+    if (strip->breakFromPattern == true)
+    {
+      audioStop();
+      return;
+    }
+
+    //  3. Measure the bands.
+    audioAnalyze(block);
+
+    //  4. Show the bands.
+    fillStripWithSolidColor(strip, color(audioLevel[AUDIO_BAND_BASS],
+                                         audioLevel[AUDIO_BAND_MID],
+                                         audioLevel[AUDIO_BAND_TREBLE]));
+  }
+
+  //  5. Stop sampling.
+  audioStop();
+
+  strip->inInterrupt = false;
+  return;
+}
+
+//******************************************************************************
+//******************************************************************************
+//   AUDIO HELPER FUNCTIONS
+//******************************************************************************
+//******************************************************************************
+
+// Start Timer_A -> ADC10 -> DTC sampling into audioBuffer[].
+//
+// PSUEDO:
+//  1. Analog input on the microphone pin.
+//  2. ADC10: single channel, repeated, triggered by Timer_A OUT1.
+//  3. DTC: continuous two-block transfer into audioBuffer[].
+//  4. Timer_A: up mode at AUDIO_SAMPLE_RATE, OUT1 set/reset half way.
+void audioStart(void)
+{
+  audioReadyBlock = 0;
+  audioOverruns = 0;
+
+  //  1. Analog input on the microphone pin.
+  AUDIO_INPUT_PORT_SEL |= AUDIO_INPUT_PIN;
+
+  //  2. ADC10: single channel, repeated, triggered by Timer_A OUT1.
+  //     ADC10CLK = SMCLK/4 = 4MHz (6.3MHz max).
+  ADC10CTL0 &= ~ENC;
+  ADC10CTL1 = AUDIO_INPUT_CHANNEL | SHS_1 | ADC10DIV_3 | ADC10SSEL_3 | CONSEQ_2;
+  ADC10CTL0 = SREF_0 | ADC10SHT_2 | ADC10ON | ADC10IE;
+
+  //  3. DTC: continuous two-block transfer into audioBuffer[].
+  //     Writing ADC10SA arms the DTC.
+  ADC10DTC0 = ADC10TB | ADC10CT;
+  ADC10DTC1 = AUDIO_BLOCK_SIZE;
+  ADC10SA = (uint16_t)audioBuffer;
+  ADC10CTL0 |= ENC;
+
+  //  4. Timer_A: up mode at AUDIO_SAMPLE_RATE, OUT1 set/reset half way.
+  TACCR0 = (16000000 / AUDIO_SAMPLE_RATE) - 1;
+  TACCR1 = (16000000 / AUDIO_SAMPLE_RATE) / 2;
+  TACCTL1 = OUTMOD_3;
+  TACTL = TASSEL_2 | MC_1 | TACLR;
+}
+
+
+// Stop sampling and power down the ADC10.
+void audioStop(void)
+{
+  TACTL = 0;
+  TACCTL1 = 0;
+  ADC10CTL0 &= ~ENC;
+  ADC10CTL0 = 0;
+  ADC10DTC0 = 0;
+  AUDIO_INPUT_PORT_SEL &= ~AUDIO_INPUT_PIN;
+  audioReadyBlock = 0;
+}
+
+
+// Goertzel band energies for one block of AUDIO_BLOCK_SIZE 10-bit samples.
+// Results go to audioLevel[] (0-255, log scaled, peak held).
+//
+// PSUEDO:
+//  1. Remove the DC offset (mic bias) with the block mean.
+//  2. Run each band's Goertzel filter over the block.
+//  3. power = s1^2 + s2^2 - coeff*s1*s2  (scaled down to 16 bits first).
+//  4. Log2 compress the power to 8 bits, falling back slowly from peaks.
+void audioAnalyze(const uint16_t *samples)
+{
+  uint16_t n, mean = 0;
+  uint8_t band, bit, level;
+  int16_t a, b;
+  int32_t power;
+
+  //  1. Remove the DC offset (mic bias) with the block mean.
+  for (n = 0; n < AUDIO_BLOCK_SIZE; n++)
+  {
+    mean += samples[n];
+  }
+  mean >>= AUDIO_BLOCK_SHIFT;
+
+  for (band = 0; band < NUMBER_OF_AUDIO_BANDS; band++)
+  {
+    //  2. Run each band's Goertzel filter over the block.
+    //     s0 = x + coeff*s1 - s2
+    goertzelS1 = 0;
+    goertzelS2 = 0;
+    for (n = 0; n < AUDIO_BLOCK_SIZE; n++)
+    {
+      int32_t s0 = (int16_t)(samples[n] - mean)
+                 + multiplyQ12(goertzelS1, goertzelCoefficient[band])
+                 - goertzelS2;
+      goertzelS2 = goertzelS1;
+      goertzelS1 = s0;
+    }
+
+    //  3. power = s1^2 + s2^2 - coeff*s1*s2  (scaled down to 16 bits first).
+    a = (int16_t)(goertzelS1 >> 4);
+    b = (int16_t)(goertzelS2 >> 4);
+    power = (int32_t)a * a + (int32_t)b * b
+          - multiplyQ12((int32_t)a * b, goertzelCoefficient[band]);
+    if (power < 0)
+      power = 0;  // Rounding only, the true power is never negative.
+
+    //  4. Log2 compress the power to 8 bits: 8 * msb + next 3 bits.
+    level = 0;
+    for (bit = 30; bit != 0; bit--)
+    {
+      if (power & 0x40000000)
+      {
+        level = (bit << 3) | (uint8_t)((power >> 27) & 0x07);
+        break;
+      }
+      power <<= 1;
+    }
+    level = qsub8(level, 64);   // Noise floor.
+    level = qadd8(level, level);
+
+    if (level > audioLevel[band])
+      audioLevel[band] = level;
+    else
+      audioLevel[band] = qsub8(audioLevel[band], 8);
+  }
+}
+
+
+// (x * coefficient) >> 12 without a hardware multiplier.  Walks the 12
+// fractional bits LSB first (see scale8()), then adds the integer part,
+// which is 0 or 1 for |coefficient| < 2.0.
+static int32_t multiplyQ12(int32_t x, int16_t coefficient)
+{
+  int32_t result = 0;
+  uint16_t c = (coefficient < 0) ? -coefficient : coefficient;
+  uint8_t bit;
+
+  for (bit = 12; bit != 0; bit--)
+  {
+    if (c & 0x01)
+      result += x;
+    result >>= 1;
+    c >>= 1;
+  }
+  if (c)
+    result += x;
+
+  return (coefficient < 0) ? -result : result;
+}
+
+
+// ADC10 ISR.  The DTC has just filled one half of audioBuffer[].
+#pragma vector=ADC10_VECTOR
+__interrupt void ADC10_ISR(void)
+{
+  if (audioReadyBlock != 0)
+    audioOverruns++;
+
+  // ADC10B1 set: block 1 (first half) is full.
+  if (ADC10DTC0 & ADC10B1)
+    audioReadyBlock = audioBuffer;
+  else
+    audioReadyBlock = &audioBuffer[AUDIO_BLOCK_SIZE];
+
+  __bic_SR_register_on_exit(LPM0_bits);
+}
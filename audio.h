@@ -0,0 +1,46 @@
+/*
+ * audio.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ */
+
+#ifndef AUDIO_H_
+#define AUDIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "WS2812B_Strip.h"
+
+// Microphone input on P2.0/A0.
+#define AUDIO_INPUT_PORT_SEL   ADC10AE0
+#define AUDIO_INPUT_PIN        BIT0
+#define AUDIO_INPUT_CHANNEL    INCH_0
+
+// Sampling: Timer_A OUT1 triggers one ADC10 conversion per period and the
+// DTC moves it to RAM, so the CPU is not involved (and interrupts may be off).
+#define AUDIO_SAMPLE_RATE      4000   // Hz.  16MHz / 4000 = 4000 SMCLK per sample.
+#define AUDIO_BLOCK_SHIFT      5
+#define AUDIO_BLOCK_SIZE       (1 << AUDIO_BLOCK_SHIFT)  // 32 samples = 8ms per block.
+
+// Goertzel bins, k = f * AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE (125Hz per bin).
+#define NUMBER_OF_AUDIO_BANDS  3
+#define AUDIO_BAND_BASS        0      // k = 1,  125Hz
+#define AUDIO_BAND_MID         1      // k = 4,  500Hz
+#define AUDIO_BAND_TREBLE      2      // k = 12, 1500Hz
+
+// Level 0 - 255 of each band after the last audioAnalyze().
+extern uint8_t audioLevel[NUMBER_OF_AUDIO_BANDS];
+
+// Blocks the DTC overwrote before they were analyzed.
+extern volatile uint16_t audioOverruns;
+
+// Callable Patterns.
+void audioPulse(struct WS2812B_Strip *strip);
+
+// Audio helper functions
+void audioStart(void);
+void audioStop(void);
+void audioAnalyze(const uint16_t *samples);
+
+#endif /* AUDIO_H_ */
@@ -0,0 +1,235 @@
+/*
+ * colormath.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * Color and byte math shared by the patterns and effects.
+ *
+ * No hardware multiplier, so anything that would multiply is either a table
+ * in flash (.const, no RAM cost) or a shift and add loop (scale8()).
+ *
+ * hsv() is a "rainbow" hue wheel rather than the plain three segment one
+ * Wheel() uses.  Wheel() keeps r + g + b = 255 in every segment, which
+ * looks dim in yellow and too bright in blue.  hsv() splits the wheel into
+ * eight 32 step sections (red, orange, yellow, green, aqua, blue, purple,
+ * pink) and gives yellow and orange more red and green, so all hues look
+ * about as bright as each other.  The whole wheel at full saturation and
+ * value is hueRainbow[], 1kiB of flash, so the common case is a lookup;
+ * only desaturating or dimming costs scale8() calls.
+ *
+ * CYCLES PER CONVERSION (host/bench.c 'colormath', median over all hues):
+ *      Wheel():                      ~40 cycles  (* 3 is a shift and add)
+ *      hsv(hue, 255, 255):           ~30 cycles  (table lookup)
+ *      hsv(hue, saturation, value): ~800-1000 cycles  (+ six scale8())
+ *  The rainbow patterns can use hsv() at full saturation and value for no
+ *  more than Wheel() costs.
+ */
+
+#include "colormath.h"
+#include "patterns.h"
+
+// hsv() at full saturation and value for every hue, packed RGB.  Within
+// a section a channel ramps by a third (0-83) or two thirds (0-166) of the
+// section, round(offset * 8 / 3) and twice that.
+static const uint32_t hueRainbow[256] = {
+  // Red -> orange
+  0xFF0000, 0xFC0300, 0xFA0500, 0xF70800, 0xF40B00, 0xF20D00, 0xEF1000, 0xEC1300,
+  0xEA1500, 0xE71800, 0xE41B00, 0xE21D00, 0xDF2000, 0xDC2300, 0xDA2500, 0xD72800,
+  0xD42B00, 0xD22D00, 0xCF3000, 0xCC3300, 0xCA3500, 0xC73800, 0xC43B00, 0xC23D00,
+  0xBF4000, 0xBC4300, 0xBA4500, 0xB74800, 0xB44B00, 0xB24D00, 0xAF5000, 0xAC5300,
+  // Orange -> yellow
+  0xAB5500, 0xAB5800, 0xAB5A00, 0xAB5D00, 0xAB6000, 0xAB6200, 0xAB6500, 0xAB6800,
+  0xAB6A00, 0xAB6D00, 0xAB7000, 0xAB7200, 0xAB7500, 0xAB7800, 0xAB7A00, 0xAB7D00,
+  0xAB8000, 0xAB8200, 0xAB8500, 0xAB8800, 0xAB8A00, 0xAB8D00, 0xAB9000, 0xAB9200,
+  0xAB9500, 0xAB9800, 0xAB9A00, 0xAB9D00, 0xABA000, 0xABA200, 0xABA500, 0xABA800,
+  // Yellow -> green
+  0xABAA00, 0xA5AD00, 0xA1AF00, 0x9BB200, 0x95B500, 0x91B700, 0x8BBA00, 0x85BD00,
+  0x81BF00, 0x7BC200, 0x75C500, 0x71C700, 0x6BCA00, 0x65CD00, 0x61CF00, 0x5BD200,
+  0x55D500, 0x51D700, 0x4BDA00, 0x45DD00, 0x41DF00, 0x3BE200, 0x35E500, 0x31E700,
+  0x2BEA00, 0x25ED00, 0x21EF00, 0x1BF200, 0x15F500, 0x11F700, 0x0BFA00, 0x05FD00,
+  // Green -> aqua
+  0x00FF00, 0x00FC03, 0x00FA05, 0x00F708, 0x00F40B, 0x00F20D, 0x00EF10, 0x00EC13,
+  0x00EA15, 0x00E718, 0x00E41B, 0x00E21D, 0x00DF20, 0x00DC23, 0x00DA25, 0x00D728,
+  0x00D42B, 0x00D22D, 0x00CF30, 0x00CC33, 0x00CA35, 0x00C738, 0x00C43B, 0x00C23D,
+  0x00BF40, 0x00BC43, 0x00BA45, 0x00B748, 0x00B44B, 0x00B24D, 0x00AF50, 0x00AC53,
+  // Aqua -> blue
+  0x00AB55, 0x00A55B, 0x00A15F, 0x009B65, 0x00956B, 0x00916F, 0x008B75, 0x00857B,
+  0x00817F, 0x007B85, 0x00758B, 0x00718F, 0x006B95, 0x00659B, 0x00619F, 0x005BA5,
+  0x0055AB, 0x0051AF, 0x004BB5, 0x0045BB, 0x0041BF, 0x003BC5, 0x0035CB, 0x0031CF,
+  0x002BD5, 0x0025DB, 0x0021DF, 0x001BE5, 0x0015EB, 0x0011EF, 0x000BF5, 0x0005FB,
+  // Blue -> purple
+  0x0000FF, 0x0300FC, 0x0500FA, 0x0800F7, 0x0B00F4, 0x0D00F2, 0x1000EF, 0x1300EC,
+  0x1500EA, 0x1800E7, 0x1B00E4, 0x1D00E2, 0x2000DF, 0x2300DC, 0x2500DA, 0x2800D7,
+  0x2B00D4, 0x2D00D2, 0x3000CF, 0x3300CC, 0x3500CA, 0x3800C7, 0x3B00C4, 0x3D00C2,
+  0x4000BF, 0x4300BC, 0x4500BA, 0x4800B7, 0x4B00B4, 0x4D00B2, 0x5000AF, 0x5300AC,
+  // Purple -> pink
+  0x5500AB, 0x5800A8, 0x5A00A6, 0x5D00A3, 0x6000A0, 0x62009E, 0x65009B, 0x680098,
+  0x6A0096, 0x6D0093, 0x700090, 0x72008E, 0x75008B, 0x780088, 0x7A0086, 0x7D0083,
+  0x800080, 0x82007E, 0x85007B, 0x880078, 0x8A0076, 0x8D0073, 0x900070, 0x92006E,
+  0x95006B, 0x980068, 0x9A0066, 0x9D0063, 0xA00060, 0xA2005E, 0xA5005B, 0xA80058,
+  // Pink -> red
+  0xAA0055, 0xAD0052, 0xAF0050, 0xB2004D, 0xB5004A, 0xB70048, 0xBA0045, 0xBD0042,
+  0xBF0040, 0xC2003D, 0xC5003A, 0xC70038, 0xCA0035, 0xCD0032, 0xCF0030, 0xD2002D,
+  0xD5002A, 0xD70028, 0xDA0025, 0xDD0022, 0xDF0020, 0xE2001D, 0xE5001A, 0xE70018,
+  0xEA0015, 0xED0012, 0xEF0010, 0xF2000D, 0xF5000A, 0xF70008, 0xFA0005, 0xFD0002
+};
+
+// 128 + 127 * sin(2 * pi * i / 256)
+static const uint8_t sineTable[256] = {
+  128, 131, 134, 137, 140, 144, 147, 150, 153, 156, 159, 162, 165, 168, 171, 174,
+  177, 179, 182, 185, 188, 191, 193, 196, 199, 201, 204, 206, 209, 211, 213, 216,
+  218, 220, 222, 224, 226, 228, 230, 232, 234, 235, 237, 239, 240, 241, 243, 244,
+  245, 246, 248, 249, 250, 250, 251, 252, 253, 253, 254, 254, 254, 255, 255, 255,
+  255, 255, 255, 255, 254, 254, 254, 253, 253, 252, 251, 250, 250, 249, 248, 246,
+  245, 244, 243, 241, 240, 239, 237, 235, 234, 232, 230, 228, 226, 224, 222, 220,
+  218, 216, 213, 211, 209, 206, 204, 201, 199, 196, 193, 191, 188, 185, 182, 179,
+  177, 174, 171, 168, 165, 162, 159, 156, 153, 150, 147, 144, 140, 137, 134, 131,
+  128, 125, 122, 119, 116, 112, 109, 106, 103, 100,  97,  94,  91,  88,  85,  82,
+   79,  77,  74,  71,  68,  65,  63,  60,  57,  55,  52,  50,  47,  45,  43,  40,
+   38,  36,  34,  32,  30,  28,  26,  24,  22,  21,  19,  17,  16,  15,  13,  12,
+   11,  10,   8,   7,   6,   6,   5,   4,   3,   3,   2,   2,   2,   1,   1,   1,
+    1,   1,   1,   1,   2,   2,   2,   3,   3,   4,   5,   6,   6,   7,   8,  10,
+   11,  12,  13,  15,  16,  17,  19,  21,  22,  24,  26,  28,  30,  32,  34,  36,
+   38,  40,  43,  45,  47,  50,  52,  55,  57,  60,  63,  65,  68,  71,  74,  77,
+   79,  82,  85,  88,  91,  94,  97, 100, 103, 106, 109, 112, 116, 119, 122, 125
+};
+
+// Smoothstep, 255 * (3t^2 - 2t^3) for t = i / 255.
+static const uint8_t easeTable[256] = {
+    0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   2,   2,   2,   3,
+    3,   3,   4,   4,   4,   5,   5,   6,   6,   7,   7,   8,   9,   9,  10,  10,
+   11,  12,  12,  13,  14,  15,  15,  16,  17,  18,  18,  19,  20,  21,  22,  23,
+   24,  25,  26,  27,  27,  28,  29,  30,  31,  33,  34,  35,  36,  37,  38,  39,
+   40,  41,  42,  44,  45,  46,  47,  48,  50,  51,  52,  53,  54,  56,  57,  58,
+   60,  61,  62,  63,  65,  66,  67,  69,  70,  72,  73,  74,  76,  77,  78,  80,
+   81,  83,  84,  85,  87,  88,  90,  91,  93,  94,  96,  97,  98, 100, 101, 103,
+  104, 106, 107, 109, 110, 112, 113, 115, 116, 118, 119, 121, 122, 124, 125, 127,
+  128, 130, 131, 133, 134, 136, 137, 139, 140, 142, 143, 145, 146, 148, 149, 151,
+  152, 154, 155, 157, 158, 159, 161, 162, 164, 165, 167, 168, 170, 171, 172, 174,
+  175, 177, 178, 179, 181, 182, 183, 185, 186, 188, 189, 190, 192, 193, 194, 195,
+  197, 198, 199, 201, 202, 203, 204, 205, 207, 208, 209, 210, 211, 213, 214, 215,
+  216, 217, 218, 219, 220, 221, 222, 224, 225, 226, 227, 228, 228, 229, 230, 231,
+  232, 233, 234, 235, 236, 237, 237, 238, 239, 240, 240, 241, 242, 243, 243, 244,
+  245, 245, 246, 246, 247, 248, 248, 249, 249, 250, 250, 251, 251, 251, 252, 252,
+  252, 253, 253, 253, 254, 254, 254, 254, 254, 255, 255, 255, 255, 255, 255, 255
+};
+
+//******************************************************************************
+//******************************************************************************
+//   COLOR CONVERSION
+//******************************************************************************
+//******************************************************************************
+
+// hsv() below full saturation or value, from the full color 'rainbow'.
+// Apart from hsv(), and not static so it isn't inlined back into it, so the
+// lookup doesn't save the registers this needs.
+//
+// PSUEDO:
+//  1. Desaturate: scale the color down and lift every channel by the same
+//     floor, so saturation 0 is white.
+//  2. Scale everything by value.
+uint32_t hsvScaled(uint32_t rainbow, uint8_t saturation, uint8_t value)
+{
+  uint8_t r = (uint8_t)(rainbow >> 16), g = (uint8_t)(rainbow >> 8), b = (uint8_t)rainbow, white;
+
+  //  1. Desaturate.  scale8(x, s) <= s for s < 255, so x + white never wraps.
+  if (saturation != 255)
+  {
+    white = 255 - saturation;
+    r = scale8(r, saturation) + white;
+    g = scale8(g, saturation) + white;
+    b = scale8(b, saturation) + white;
+  }
+
+  //  2. Scale everything by value.
+  if (value != 255)
+  {
+    r = scale8(r, value);
+    g = scale8(g, value);
+    b = scale8(b, value);
+  }
+
+  return color(r, g, b);
+}
+
+
+// Hue, saturation, value (all 0-255) to packed RGB.  Full saturation and
+// value is hueRainbow[] as it is.
+uint32_t hsv(uint8_t hue, uint8_t saturation, uint8_t value)
+{
+  if ((saturation & value) != 255)
+    return hsvScaled(hueRainbow[hue], saturation, value);
+  return hueRainbow[hue];
+}
+
+//******************************************************************************
+//******************************************************************************
+//   TRIG AND EASING
+//******************************************************************************
+//******************************************************************************
+
+// Sine of theta (256 = one turn), 1-255 centred on 128.
+uint8_t sin8(uint8_t theta)
+{
+  return sineTable[theta];
+}
+
+
+// Cosine, a quarter turn on from sin8().
+uint8_t cos8(uint8_t theta)
+{
+  return sineTable[(uint8_t)(theta + 64)];
+}
+
+
+// Ease in and out: slow at both ends, 0 -> 0 and 255 -> 255.
+uint8_t ease8(uint8_t t)
+{
+  return easeTable[t];
+}
+
+//******************************************************************************
+//******************************************************************************
+//   BYTE MATH
+//******************************************************************************
+//******************************************************************************
+
+// Saturating add, a + b clamped to 255.
+uint8_t qadd8(uint8_t a, uint8_t b)
+{
+  uint16_t sum = (uint16_t)a + b;
+  if (sum > 255)
+    return 255;
+  return (uint8_t)sum;
+}
+
+
+// Saturating subtract, a - b clamped to 0.
+uint8_t qsub8(uint8_t a, uint8_t b)
+{
+  if (b > a)
+    return 0;
+  return a - b;
+}
+
+
+// (value * (scale + 1)) / 256 without a hardware multiplier, so scale 255
+// leaves value unchanged and scale 0 gives 0.
+// Shift and add, walking the bits of 'scale' LSB first so the partial sum
+// only ever shifts right and stays within 9 bits.  Starting from 'value'
+// rather than 0 is the + 1.
+uint8_t scale8(uint8_t value, uint8_t scale)
+{
+  uint16_t result = value;
+  uint8_t bit;
+
+  for (bit = 8; bit != 0; bit--)
+  {
+    if (scale & 0x01)
+      result += value;
+    result >>= 1;
+    scale >>= 1;
+  }
+  return (uint8_t)result;
+}
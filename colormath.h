@@ -0,0 +1,36 @@
+/*
+ * colormath.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ */
+
+#ifndef COLORMATH_H_
+#define COLORMATH_H_
+
+#include <stdint.h>
+
+// Handy hues for hsv(), 0-255 around the wheel.
+#define HUE_RED     0
+#define HUE_ORANGE  32
+#define HUE_YELLOW  64
+#define HUE_GREEN   96
+#define HUE_AQUA    128
+#define HUE_BLUE    160
+#define HUE_PURPLE  192
+#define HUE_PINK    224
+
+// Color conversion.
+uint32_t hsv(uint8_t hue, uint8_t saturation, uint8_t value);
+
+// 8-bit trig and easing, angles are 0-255 for one full turn.
+uint8_t sin8(uint8_t theta);
+uint8_t cos8(uint8_t theta);
+uint8_t ease8(uint8_t t);
+
+// Byte math.
+uint8_t qadd8(uint8_t a, uint8_t b);
+uint8_t qsub8(uint8_t a, uint8_t b);
+uint8_t scale8(uint8_t value, uint8_t scale);
+
+#endif /* COLORMATH_H_ */
@@ -0,0 +1,234 @@
+/*
+ * dco.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * DCO trim against a 32768Hz watch crystal.
+ *
+ * show() bit timing is counted in 16MHz cycles, so it is only as good as the
+ * DCO.  The factory CALDCO_16MHZ/CALBC1_16MHZ constants are set at 25C and
+ * 3V; in a hot enclosure the DCO drifts a few percent, and that comes
+ * straight off the WS2812B's +/-150ns margins (which the instruction
+ * timings in show() already eat into.)  With a crystal on XIN/XOUT
+ * (DCO_CRYSTAL) ACLK is a reference that does not drift:
+ *
+ *  - dcoCalibrate() (1.1 CLOCK SETUP) starts the crystal and walks DCOCTL,
+ *    carrying into RSEL in BCSCTL1, until SMCLK counts DCO_TARGET_COUNT
+ *    per 8 ACLK periods.  It stops at the ends of the RSEL range.
+ *  - dcoService() (frameWait(), when a frame has time to spare) measures
+ *    again every DCO_TRIM_INTERVAL_MS and takes one step if we have drifted
+ *    out of DCO_TOLERANCE.  One step at a time keeps the change in show()
+ *    timing between two frames down to ~0.25%.
+ *
+ * The result is in dcoStatus for the debugger's watch window.
+ *
+ * MEASURING:
+ *  Timer_A counts SMCLK and CCR2 captures ACLK/8 (CCI2B) rising edges; the
+ *  difference between two captures is one measurement.  Timer_A is also the
+ *  audio sample clock, so dcoService() leaves it alone while audioPulse()
+ *  has it running.  Interrupts are off for the < 0.5ms it takes, like
+ *  show(), so an ISR can not make us miss a capture.
+ *
+ * Trimming the DCO also trims the timebase (SMCLK/8), which is the point:
+ * delay_ms() and frame periods come out right as well.
+ */
+
+#include <msp430f2272.h>
+#include "dco.h"
+#include "scheduler.h"
+
+#define DCO_RSEL_MASK  (RSEL3 | RSEL2 | RSEL1 | RSEL0)
+#define DCO_TAP_7      0xE0
+
+// Each RSEL is ~1.35x the one below and each DCO tap ~1.08x (the F2xx
+// datasheet's typical S_RSEL and S_DCO), so one RSEL is ~3.9 taps.  Going
+// up from tap 7, RSEL + 1 at tap 3 + 4/32 is just above it; going down from
+// tap 0, RSEL - 1 at tap 3 + 28/32 is just below.  The next measurement
+// takes care of a part that is off the typical slopes.
+#define DCO_CARRY_UP    0x64
+#define DCO_CARRY_DOWN  0x7C
+
+struct DcoStatus dcoStatus;
+
+// Timebase tick of the last dcoService() measurement.
+static uint32_t dcoLastTrim;
+
+static uint16_t dcoMeasure(void);
+static bool dcoUpdate(const uint16_t count);
+static void dcoStep(void);
+
+
+// Start the crystal and trim the DCO onto it.  Call from 1.1 CLOCK SETUP,
+// with interrupts off.  Returns false (and leaves the factory constants
+// alone) if there is no crystal or it will not start.
+//
+// PSUEDO:
+//  1. ACLK = LFXT1 watch crystal, divided by 8.
+//  2. Wait for the crystal to start, clearing the fault flag as we go.
+//  3. Measure and step until we are within DCO_TOLERANCE.
+bool dcoCalibrate(void)
+{
+  uint16_t step, count;
+
+  dcoStatus.locked = false;
+  if (DCO_CRYSTAL == 0)
+    return false;
+
+  //  1. ACLK = LFXT1 watch crystal, divided by 8.
+  BCSCTL3 = LFXT1S_0 | XCAP_3;   // 32768Hz, 12.5pF load.
+  BCSCTL1 |= DIVA_3;
+
+  //  2. Wait for the crystal to start, clearing the fault flag as we go.
+  for (step = DCO_CRYSTAL_START_MS / 10; step != 0; step--)
+  {
+    IFG1 &= ~OFIFG;
+    __delay_cycles(160000);      // 10ms
+    if ((BCSCTL3 & LFXT1OF) == 0)
+      break;
+  }
+  if (step == 0)
+    return false;
+
+  //  3. Measure and step until we are within DCO_TOLERANCE.
+  for (step = 0; step < DCO_CALIBRATE_STEPS; step++)
+  {
+    count = dcoMeasure();
+    if (count == 0)
+      return false;
+    if (dcoUpdate(count))
+    {
+      dcoStatus.locked = true;
+      break;
+    }
+    dcoStep();
+  }
+
+  return dcoStatus.locked;
+}
+
+
+// Between frames: re-measure every DCO_TRIM_INTERVAL_MS and take one step
+// if we have drifted.  'deadline' is when the next frame is due, we only
+// measure if there are DCO_TRIM_SLACK_MS to spare before it.
+void dcoService(const uint32_t deadline)
+{
+  uint32_t now;
+  uint16_t count;
+
+  if (dcoStatus.locked == false)
+    return;
+  if (TACTL & MC_3)
+    return;                      // Timer_A is sampling audio.
+
+  now = timebaseNow();
+  if ((int32_t)(deadline - now) < (int32_t)DCO_TRIM_SLACK_MS * TIMEBASE_TICKS_PER_MS)
+    return;
+  if ((now - dcoLastTrim) < (uint32_t)DCO_TRIM_INTERVAL_MS * TIMEBASE_TICKS_PER_MS)
+    return;
+  dcoLastTrim = now;
+
+  count = dcoMeasure();
+  if (count == 0)
+  {
+    dcoStatus.locked = false;    // Crystal has stopped, stay where we are.
+    return;
+  }
+  if (dcoUpdate(count) == false)
+    dcoStep();
+}
+
+
+// SMCLK ticks in 8 ACLK periods, 0 if ACLK is not running.
+//
+// PSUEDO:
+//  1. Timer_A continuous from SMCLK, CCR2 captures ACLK rising edges.
+//  2. Wait for two captures, the count is the difference.
+//  3. Hand Timer_A back stopped.
+static uint16_t dcoMeasure(void)
+{
+  uint16_t interruptsOn = __get_SR_register() & GIE;
+  uint16_t first = 0, count = 0, timeout = 0;
+  uint8_t capture;
+
+  __bic_SR_register(GIE);
+
+  //  1. Timer_A continuous from SMCLK, CCR2 captures ACLK rising edges.
+  TACCTL2 = CM_1 | CCIS_1 | SCS | CAP;
+  TACTL = TASSEL_2 | MC_2 | TACLR;
+
+  //  2. Wait for two captures, the count is the difference.  Each gets
+  //     its own timeout, a slow first edge must not eat the second's.
+  for (capture = 2; capture != 0; capture--)
+  {
+    timeout = 0xFFFF;
+    while (((TACCTL2 & CCIFG) == 0) && (--timeout != 0))
+    {
+      __no_operation();
+    }
+    if (timeout == 0)
+      break;
+    count = TACCR2 - first;
+    first = TACCR2;
+    TACCTL2 &= ~CCIFG;
+  }
+
+  //  3. Hand Timer_A back stopped.
+  TACTL = 0;
+  TACCTL2 = 0;
+
+  if (interruptsOn)
+    __bis_SR_register(GIE);
+
+  return (timeout == 0) ? 0 : count;
+}
+
+
+// Record a measurement.  Returns true if it is within DCO_TOLERANCE.
+static bool dcoUpdate(const uint16_t count)
+{
+  dcoStatus.error = (int16_t)(count - DCO_TARGET_COUNT);
+  dcoStatus.errorPpm = (int32_t)dcoStatus.error * 256;
+
+  return (dcoStatus.error >= -DCO_TOLERANCE) && (dcoStatus.error <= DCO_TOLERANCE);
+}
+
+
+// One DCOCTL step towards DCO_TARGET_COUNT.  DCOCTL is DCOx:MODx, so
+// stepping it as a whole walks the modulation between neighbouring DCO taps
+// (tap 7 has no modulation, 0xE0 is the top of a range.)  Off either end of
+// the range carry into RSEL in BCSCTL1, re-entering at the tap that gives
+// the frequency we are leaving (DCO_CARRY_UP, DCO_CARRY_DOWN), so every step
+// moves the same way.  At the ends of RSEL stay put.
+static void dcoStep(void)
+{
+  uint8_t rsel = BCSCTL1 & DCO_RSEL_MASK;
+
+  if (dcoStatus.error > 0)
+  {
+    if (DCOCTL > DCO_TAP_7)
+      DCOCTL = DCO_TAP_7;
+    if (DCOCTL != 0x00)
+      DCOCTL--;
+    else if (rsel != 0)
+    {
+      BCSCTL1--;
+      DCOCTL = DCO_CARRY_DOWN;
+    }
+    else
+      return;
+  }
+  else
+  {
+    if (DCOCTL < DCO_TAP_7)
+      DCOCTL++;
+    else if (rsel != DCO_RSEL_MASK)
+    {
+      BCSCTL1++;
+      DCOCTL = DCO_CARRY_UP;
+    }
+    else
+      return;
+  }
+  dcoStatus.trims++;
+}
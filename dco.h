@@ -0,0 +1,46 @@
+/*
+ * dco.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ */
+
+#ifndef DCO_H_
+#define DCO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 1 if a 32768Hz watch crystal is fitted on XIN/XOUT (P2.6/P2.7).  Without
+// it we stay on the factory CALDCO_16MHZ/CALBC1_16MHZ constants.
+#ifndef DCO_CRYSTAL
+#define DCO_CRYSTAL  0
+#endif
+
+// SMCLK counted over 8 ACLK periods: 16MHz / (32768Hz / 8) = 3906.25.
+// One DCOCTL step moves this by ~10, so the tolerance is within reach
+// from any setting.  Each count is 256ppm.
+#define DCO_TARGET_COUNT      3906
+#define DCO_TOLERANCE         16      // +/-0.4%
+#define DCO_CALIBRATE_STEPS   512     // Boot trim gives up after this many.
+#define DCO_CRYSTAL_START_MS  1000    // Watch crystals take a while to start.
+
+// Between frames, re-measure (and trim one step) this often, if the frame
+// has at least DCO_TRIM_SLACK_MS to spare (a measurement takes < 0.5ms.)
+#define DCO_TRIM_INTERVAL_MS  5000
+#define DCO_TRIM_SLACK_MS     2
+
+struct DcoStatus {
+  bool     locked;      // Crystal running and the boot trim converged.
+  int16_t  error;       // Last measurement - DCO_TARGET_COUNT.
+  int32_t  errorPpm;    // The same in parts per million.
+  uint16_t trims;       // DCOCTL steps taken since boot.
+};
+
+// Last measurement, for the debugger's watch window.
+extern struct DcoStatus dcoStatus;
+
+bool dcoCalibrate(void);
+void dcoService(const uint32_t deadline);
+
+#endif /* DCO_H_ */
@@ -0,0 +1,330 @@
+/*
+ * effects.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * Fire, meteor rain and sparkle effects.
+ *
+ * The F2272 has no hardware multiplier and only 1kiB of RAM, so everything
+ * here is integer/fixed point:
+ *  - random8() is a 16-bit LCG with the multiply unrolled into shifts.
+ *  - noise8() is 1D value noise from a permutation table in flash (.const,
+ *    no RAM cost) eased with ease8() from colormath.c.
+ *  - One shared per-pixel byte buffer holds the fire heat / twinkle levels,
+ *    only one effect runs at a time.
+ *  - meteorRain() uses a fixed pool of NUMBER_OF_PARTICLES, no malloc().
+ *  - Heat and decay use saturating byte math (qadd8/qsub8) so nothing wraps.
+ *
+ * CYCLE BUDGET (38 pixels @16MHz, not counting show() or frameWait()):
+ *      fire():       24000 cycles/frame (1.5ms)
+ *      meteorRain(): 16000 cycles/frame (1.0ms)
+ *      sparkle():    32000 cycles/frame (2.0ms)
+ *  Most of it goes on the three brightness multiplies in setPixelColor()
+ *  (and fire()'s scale8() in heatColor()).  'make -C host bench' prints
+ *  the estimate for each against its budget, see host/bench.c; they move
+ *  with the host machine, so they aren't copied here.
+ */
+
+#include "effects.h"
+#include "patterns.h"
+
+// Per pixel scratch buffer: heat for fire(), twinkle level for sparkle().
+static uint8_t effectBuffer[NUMBER_OF_PIXELS];
+
+// Fixed particle pool for meteorRain().
+static struct Particle particles[NUMBER_OF_PARTICLES];
+
+static uint16_t randomSeed = 0x1337;
+
+// Permutation table for noise8().  Any shuffle of 0-255 works.
+static const uint8_t noisePermutation[256] = {
+   25, 159,  64,  78, 144, 222, 193, 132, 148, 151,  46,  15,  63,  82, 187, 172,
+   90, 155,  54,  79, 214, 124,  24, 249, 125,  14,  32, 165, 227, 208, 235, 150,
+   57, 246,  84, 108, 170,  81,  36, 213,  83, 160, 102,  52, 119, 225,  21, 198,
+   49,  48, 209, 219, 251,  26,  19, 202, 188, 200, 177, 184,  56,  87, 141, 205,
+  138, 146,  18,  97,  28, 231,  55,  85,  99, 233, 103,  86, 121,  35, 171, 157,
+  104, 116,  37, 112,  23, 201,   2, 210,  72,  80,  92, 194, 127, 156,  40, 142,
+  120, 216,  77, 232, 111, 139, 118,   7,  70,  96, 239, 234,  45, 197, 176, 129,
+   50, 215,  43, 174,  12,  66,  93, 192,  67,  58, 143, 179, 199, 130,  44,   4,
+  236,  68, 238, 253, 203,   0, 180, 149, 136, 147,  17,  41, 178,  13, 185, 229,
+  211, 115, 223, 161,  94, 134, 114,  60,  51, 153,  53,  11,  71, 182,  65,   5,
+  126, 241,  88, 123,  59,  62,  98,   1, 135, 218, 189, 181, 252, 133,  74,  76,
+    9, 247, 105, 128, 206, 245,  42, 207,   6, 220, 228, 168, 212, 164, 113, 106,
+   27, 158, 175,  69,  91,  95, 244, 255,  16,  47,  20, 109, 122, 224, 240, 173,
+  242,  31,  38,  61, 226,  73, 230, 140, 101,  30, 100, 117, 137, 195, 162, 221,
+  169, 154,   3,  75,  29, 243, 248, 145,   8,  89, 191, 110, 152, 217, 183,  34,
+  237, 196, 107, 131, 167, 204,  22, 186, 254, 190,  33,  10, 250, 166, 163,  39
+};
+
+static uint16_t randomPixel(const struct WS2812B_Strip *strip);
+
+//******************************************************************************
+//******************************************************************************
+//  EFFECTS
+//******************************************************************************
+//******************************************************************************
+
+
+// Flickering flame rising from pixel 0.
+//  cooling:  how much the flame cools as it rises (bigger = shorter flame).
+//  sparking: chance (out of 255) of a new spark each frame.
+//
+// PSUEDO:
+//  1. Cool every cell down a little.
+//  2. Heat drifts up and diffuses.
+//  3. Randomly ignite new sparks near the bottom.
+//  4. Map heat to color.
+void fire(struct WS2812B_Strip *strip, const uint8_t cooling, const uint8_t sparking, const uint8_t delayTime)
+{
+  uint16_t pixelIndex, j;
+  uint8_t coolMask = 1;
+  uint8_t *heat = effectBuffer;
+
+  clear(strip);
+  show(strip);
+
+  for (pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex++)
+  {
+    heat[pixelIndex] = 0;
+  }
+
+  // Round 'cooling' up to a bit mask once, so each pixel only needs an AND
+  // rather than a multiply/divide to pick its random cool down.
+  while (coolMask < cooling)
+  {
+    coolMask = (coolMask << 1) | 1;
+  }
+
+  frameBegin(strip, delayTime);
+  for (j = 0; j < 256; j += frameWait(strip))
+  {
+    if (strip->breakFromPattern == true)
+    {
+      return;
+    }
+
+    //  1. Cool every cell down a little.
+    for (pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex++)
+    {
+      heat[pixelIndex] = qsub8(heat[pixelIndex], random8() & coolMask);
+    }
+
+    //  2. Heat drifts up and diffuses.  (h[-1] + 2*h[-2] + h[-3]) / 4
+    for (pixelIndex = strip->numberOfPixels - 1; pixelIndex > 2; pixelIndex--)
+    {
+      heat[pixelIndex] = (heat[pixelIndex - 1] + (heat[pixelIndex - 2] << 1) + heat[pixelIndex - 3]) >> 2;
+    }
+
+    //  3. Randomly ignite new sparks near the bottom.  Noise on the spark
+    //     rate makes the flame swell and die down instead of a steady hiss.
+    if (random8() < qadd8(sparking >> 1, scale8(sparking, noise8(j << 4))))
+    {
+      pixelIndex = random8() & 0x07;
+      if (pixelIndex < strip->numberOfPixels)
+      {
+        heat[pixelIndex] = qadd8(heat[pixelIndex], 160 + (random8() & 0x3F));
+      }
+    }
+
+    //  4. Map heat to color.
+    for (pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex++)
+    {
+      setPixelColor(strip, pixelIndex, heatColor(heat[pixelIndex]));
+    }
+
+    show(strip);
+  }
+
+  strip->inInterrupt = false;
+  return;
+}
+
+
+// Meteors of 'color' falling down the strip leaving a sparkly decaying tail.
+//  trailDecay: max random fade per frame (bigger = shorter, patchier tail).
+//
+// PSUEDO:
+//  1. Fade every byte in pixels[] (saturating), randomly per byte.
+//  2. Respawn dead particles, move live ones and draw their heads.
+void meteorRain(struct WS2812B_Strip *strip, uint32_t color, const uint8_t trailDecay, const uint8_t delayTime)
+{
+  uint16_t i, j, head;
+  uint8_t *ptr;
+  struct Particle *p;
+
+  clear(strip);
+  show(strip);
+
+  for (i = 0; i < NUMBER_OF_PARTICLES; i++)
+  {
+    particles[i].life = 0;
+  }
+
+  frameBegin(strip, delayTime);
+  for (j = 0; j < 256; j += frameWait(strip))
+  {
+    if (strip->breakFromPattern == true)
+    {
+      return;
+    }
+
+    //  1. Fade every byte in pixels[] (saturating), randomly per byte.
+    ptr = strip->pixels;
+    for (i = 0; i < strip->numberOfBytes; i++)
+    {
+      *ptr = qsub8(*ptr, qadd8(*ptr >> 3, random8() & trailDecay));
+      ptr++;
+    }
+
+    //  2. Respawn dead particles, move live ones and draw their heads.
+    for (p = particles; p < &particles[NUMBER_OF_PARTICLES]; p++)
+    {
+      if (p->life == 0)
+      {
+        if (random8() < 16)
+        {
+          p->position = 0;
+          p->velocity = 0x40 | random8();  // 1/4 to 1 pixel per frame.
+          p->life = 255;
+        }
+        continue;
+      }
+
+      p->position += p->velocity;
+      p->life--;
+
+      head = p->position >> 8;
+      if (head < strip->numberOfPixels)
+        setPixelColor(strip, head, color);
+      else
+        p->life = 0;
+    }
+
+    show(strip);
+  }
+
+  strip->inInterrupt = false;
+  return;
+}
+
+
+// Random pixels flash color 'c' and fade out again.
+//  density: chance (out of 255) of a new twinkle each frame.
+//
+// PSUEDO:
+//  1. Fade every twinkle (saturating) and redraw it.
+//  2. Maybe start a new twinkle on a random pixel.
+void sparkle(struct WS2812B_Strip *strip, uint32_t c, const uint8_t density, const uint8_t delayTime)
+{
+  uint16_t pixelIndex, j;
+  uint8_t level;
+
+  clear(strip);
+  show(strip);
+
+  for (pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex++)
+  {
+    effectBuffer[pixelIndex] = 0;
+  }
+
+  frameBegin(strip, delayTime);
+  for (j = 0; j < 256; j += frameWait(strip))
+  {
+    if (strip->breakFromPattern == true)
+    {
+      return;
+    }
+
+    //  1. Fade every twinkle (saturating) and redraw it.
+    for (pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex++)
+    {
+      level = qsub8(effectBuffer[pixelIndex], 12);
+      effectBuffer[pixelIndex] = level;
+      setPixelColor(strip, pixelIndex, scaleColor(c, level));
+    }
+
+    //  2. Maybe start a new twinkle on a random pixel.
+    if (random8() < density)
+    {
+      effectBuffer[randomPixel(strip)] = 0xC0 | random8();
+    }
+
+    show(strip);
+  }
+
+  strip->inInterrupt = false;
+  return;
+}
+
+//******************************************************************************
+//******************************************************************************
+//   EFFECT HELPER FUNCTIONS
+//******************************************************************************
+//******************************************************************************
+
+// 8-bit pseudo random number.
+// seed = seed * 2053 + 13849, with the multiply unrolled into shifts since
+// there is no hardware multiplier.  Returns the high and low bytes mixed.
+uint8_t random8(void)
+{
+  randomSeed = (randomSeed << 11) + (randomSeed << 2) + randomSeed + 13849;
+  return (uint8_t)(randomSeed + (randomSeed >> 8));
+}
+
+
+// 1D value noise.  'x' is 8.8 fixed point: the high byte picks a lattice
+// cell, the low byte is the position within it.  Returns 0-255.
+uint8_t noise8(uint16_t x)
+{
+  uint8_t cell = (uint8_t)(x >> 8);
+  uint8_t a = noisePermutation[cell];
+  uint8_t b = noisePermutation[(uint8_t)(cell + 1)];
+  uint8_t ease = ease8((uint8_t)x);
+
+  if (b >= a)
+    return a + scale8(b - a, ease);
+  else
+    return a - scale8(a - b, ease);
+}
+
+
+// Black body approximation: black - red - yellow - white.
+// Temperature is squashed to 0-191 so it splits into three 64 step ramps.
+uint32_t heatColor(uint8_t temperature)
+{
+  uint8_t t192 = scale8(temperature, 191);  // 0 - 191, so 255 is white.
+  uint8_t heatRamp = (t192 & 0x3F) << 2;
+
+  if (t192 & 0x80)
+  {
+    return color(255, 255, heatRamp);  // Hottest.
+  }
+  else if (t192 & 0x40)
+  {
+    return color(255, heatRamp, 0);    // Middle.
+  }
+  else
+  {
+    return color(heatRamp, 0, 0);      // Coolest.
+  }
+}
+
+
+// Random pixel index in [0, numberOfPixels).  (random8() * n) / 256 done
+// with shift and add, like scale8() but with a 16-bit operand.
+static uint16_t randomPixel(const struct WS2812B_Strip *strip)
+{
+  uint16_t result = 0;
+  uint8_t r = random8();
+  uint8_t bit;
+
+  for (bit = 8; bit != 0; bit--)
+  {
+    if (r & 0x01)
+      result += strip->numberOfPixels;
+    result >>= 1;
+    r >>= 1;
+  }
+  return result;
+}
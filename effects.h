@@ -0,0 +1,40 @@
+/*
+ * effects.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ */
+
+#ifndef EFFECTS_H_
+#define EFFECTS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "WS2812B_Strip.h"
+#include "scheduler.h"
+#include "colormath.h"
+
+// Size of the fixed particle pool used by meteorRain().  No heap is used,
+// the pool lives in .bss next to the per-pixel effect buffer.
+#define NUMBER_OF_PARTICLES 4
+
+// A single meteor head.  Position is 8.8 fixed point (pixel.fraction) so
+// slow meteors can move less than one pixel per frame without multiplies.
+// Meteors only cover the first 256 pixels of longer strips.
+struct Particle {
+  uint16_t position;  // 8.8 fixed point pixel index of the head.
+  uint8_t  velocity;  // 0.8 fixed point pixels per frame (1/256 .. 255/256).
+  uint8_t  life;      // Frames left before this particle is respawned.
+};
+
+// Callable Effects.
+void fire(struct WS2812B_Strip *strip, const uint8_t cooling, const uint8_t sparking, const uint8_t delayTime);
+void meteorRain(struct WS2812B_Strip *strip, uint32_t color, const uint8_t trailDecay, const uint8_t delayTime);
+void sparkle(struct WS2812B_Strip *strip, uint32_t c, const uint8_t density, const uint8_t delayTime);
+
+// Effect helper functions
+uint8_t random8(void);
+uint8_t noise8(uint16_t x);
+uint32_t heatColor(uint8_t temperature);
+
+#endif /* EFFECTS_H_ */
@@ -0,0 +1,363 @@
+/*
+ * bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * Render cost of the patterns and the code under them, on the host:
+ *
+ *   bench [section]
+ *
+ * The virtual MCU (host.c) only times port accesses and sleeps, C code in
+ * between is free, so this times the host CPU instead (median of
+ * BENCH_RUNS) and scales it to F2272 cycles against a byte loop of known
+ * cost (benchReference().)  That is a rough estimate: the host multiplies
+ * in hardware where the F2272 calls a shift and add routine, so multiply
+ * heavy code comes out cheaper here than it is.  Keep a margin under any
+ * budget.  Ratios between two versions of the same job are more
+ * trustworthy than the absolute numbers.
+ *
+ * show() is kept out of the frame timings by holding strip.inShow, which
+ * makes it return straight away, and the same frame loop with nothing in
+ * it is timed and taken off.
+ *
+ * 'make bench' runs every section.  It is timing, so it is not part of
+ * 'make test', but it exits 1 if an estimate is over its budget.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <msp430f2272.h>
+#include "main.h"
+#include "patterns.h"
+#include "effects.h"
+#include "colormath.h"
+#include "scheduler.h"
+#include "WS2812B_Strip.h"
+
+#define BENCH_RUNS             31
+#define BENCH_FRAMES           1024
+#define BENCH_REFERENCE_BYTES  4096
+#define BENCH_REFERENCE_CYCLES 11      // Per byte, see benchReference().
+
+extern struct WS2812B_Strip strip;
+
+static int benchFailures;
+static uint8_t benchSource[BENCH_REFERENCE_BYTES], benchDestination[BENCH_REFERENCE_BYTES];
+
+
+static double benchNow(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+
+// On the F2272: mov.b @R12+,R14 (2), add.b #3,R14 (1), mov.b R14,0(R15)
+// (4), inc R15 (1), dec R11 (1), jnz (2).  Kept a plain loop on the host.
+__attribute__((noinline, optimize("no-tree-loop-distribute-patterns", "no-tree-vectorize")))
+static void benchReference(void)
+{
+  const uint8_t *src = benchSource;
+  uint8_t *dst = benchDestination;
+  uint16_t i;
+
+  for (i = BENCH_REFERENCE_BYTES; i != 0; i--)
+  {
+    *dst++ = *src++ + 3;
+    __asm__ volatile("" ::: "memory");
+  }
+}
+
+
+static double benchTimeOnce(void (*run)(void), uint32_t calls)
+{
+  double start = benchNow();
+  uint32_t i;
+
+  for (i = 0; i < calls; i++)
+    run();
+  return (benchNow() - start) / calls;
+}
+
+
+static int benchCompare(const void *a, const void *b)
+{
+  double difference = *(const double *)a - *(const double *)b;
+  return (difference > 0) - (difference < 0);
+}
+
+
+// F2272 cycles per call of 'run', less one call of 'baseline' (if any.)
+// Each of the BENCH_RUNS is scaled by a run of benchReference() right next
+// to it, so the host clock changing speed mostly cancels out; the median
+// of them is returned.
+static double benchCycles(void (*run)(void), void (*baseline)(void), uint32_t calls)
+{
+  double cycles[BENCH_RUNS], reference, ns;
+  uint8_t r;
+
+  for (r = 0; r < BENCH_RUNS; r++)
+  {
+    reference = benchTimeOnce(benchReference, 16);
+    ns = benchTimeOnce(run, calls);
+    if (baseline)
+      ns -= benchTimeOnce(baseline, calls);
+    reference = (reference + benchTimeOnce(benchReference, 16)) / 2;
+    cycles[r] = ns * BENCH_REFERENCE_BYTES * BENCH_REFERENCE_CYCLES / reference;
+  }
+  qsort(cycles, BENCH_RUNS, sizeof(cycles[0]), benchCompare);
+  return cycles[BENCH_RUNS / 2];
+}
+
+
+static void benchBudget(const char *name, double cycles, double budget)
+{
+  bool ok = cycles <= budget;
+
+  if (ok == false)
+    benchFailures++;
+  printf("%s %-28s %7.0f cycles (budget %6.0f)\n", ok ? "ok  " : "OVER", name, cycles, budget);
+}
+
+
+//******************************************************************************
+//  Whole frames: a pattern with show() held off, for BENCH_FRAMES periods.
+//******************************************************************************
+
+static void (*benchPattern)(void);
+static uint8_t benchDelay;
+static bool benchDone;
+
+
+static void benchStop(uint32_t unused)
+{
+  benchDone = true;
+  strip.breakFromPattern = true;
+}
+
+
+static void benchRunPattern(void (*pattern)(void))
+{
+  hostReset();
+  hostTimeLimit = 0;
+  create(&strip, NUMBER_OF_PIXELS);
+  setBrightness(&strip, 64);
+  timebaseInit();
+  __bis_SR_register(GIE);
+
+  strip.inShow = true;
+  benchDone = false;
+  hostSchedule(hostCycles + (uint64_t)BENCH_FRAMES * benchDelay * HOST_CYCLES_PER_MS, benchStop, 0);
+  while (benchDone == false)
+  {
+    strip.breakFromPattern = false;
+    pattern();
+  }
+}
+
+
+// The frame loop every pattern has, with nothing in it.
+static void benchIdle(void)
+{
+  uint16_t j;
+
+  frameBegin(&strip, benchDelay);
+  for (j = 0; j < 256; j += frameWait(&strip))
+  {
+    if (strip.breakFromPattern == true)
+      return;
+    show(&strip);
+  }
+}
+
+
+static void benchRunFrames(void) { benchRunPattern(benchPattern); }
+static void benchRunIdle(void)   { benchRunPattern(benchIdle); }
+
+
+// F2272 cycles a frame of 'pattern' takes to render, at 'delayTime' ms
+// a frame.
+static double benchFrame(void (*pattern)(void), uint8_t delayTime)
+{
+  benchDelay = delayTime;
+  benchPattern = pattern;
+  return benchCycles(benchRunFrames, benchRunIdle, 1) / BENCH_FRAMES;
+}
+
+
+//******************************************************************************
+//  effects.c: each effect's 38 pixel frame against its budget in the
+//  CYCLE BUDGET comment.
+//******************************************************************************
+
+static void benchFire(void)       { fire(&strip, 55, 120, 15); }
+static void benchMeteorRain(void) { meteorRain(&strip, color(0xFF, 0xFF, 0xFF), 0x1F, 30); }
+static void benchSparkle(void)    { sparkle(&strip, color(0xFF, 0xFF, 0xFF), 80, 20); }
+
+static void benchEffects(void)
+{
+  benchBudget("fire()", benchFrame(benchFire, 15), 24000);
+  benchBudget("meteorRain()", benchFrame(benchMeteorRain, 30), 16000);
+  benchBudget("sparkle()", benchFrame(benchSparkle, 20), 32000);
+}
+
+
+//******************************************************************************
+//  colormath.c: one conversion of each kind, against the CYCLES PER
+//  CONVERSION comment, over all 256 hues.  hsv() at full saturation and
+//  value must cost no more than Wheel(), plus 25% for timing noise.
+//******************************************************************************
+
+static volatile uint32_t benchSink;
+
+
+static void benchNoConversion(void)
+{
+  uint16_t hue;
+
+  for (hue = 0; hue < 256; hue++)
+    benchSink = hue;
+}
+
+
+static void benchWheel(void)
+{
+  uint16_t hue;
+
+  for (hue = 0; hue < 256; hue++)
+    benchSink = Wheel(hue);
+}
+
+
+static void benchHsvFull(void)
+{
+  uint16_t hue;
+
+  for (hue = 0; hue < 256; hue++)
+    benchSink = hsv(hue, 255, 255);
+}
+
+
+static void benchHsvScaled(void)
+{
+  uint16_t hue;
+
+  for (hue = 0; hue < 256; hue++)
+    benchSink = hsv(hue, 200, 180);
+}
+
+
+static void benchColormath(void)
+{
+  double wheel = benchCycles(benchWheel, benchNoConversion, 512) / 256;
+  double full = benchCycles(benchHsvFull, benchNoConversion, 512) / 256;
+
+  benchBudget("Wheel()", wheel, 100);
+  benchBudget("hsv(hue, 255, 255)", full, wheel * 1.25);
+  benchBudget("hsv(hue, saturation, value)", benchCycles(benchHsvScaled, benchNoConversion, 512) / 256, 1500);
+  printf("     hsv(hue, 255, 255) is %.2f x Wheel()\n", full / wheel);
+}
+
+
+//******************************************************************************
+//  WS2812B_Strip.c RANGE PRIMITIVES: each against the setPixelColor() loop
+//  it replaces, at several strip lengths.  The budget is that loop, plus
+//  25% for timing noise (blitPixels() on a short strip is mostly its first
+//  period, which is the loop.)  Brightness is on, so setPixelColor() does
+//  its three multiplies, which are cheap here and library calls on the
+//  F2272: the real speedups are bigger.
+//******************************************************************************
+
+static const uint32_t benchPolice[2] = { 0xFF0000, 0x0000FF };
+
+
+static void benchSetPixelFill(void)
+{
+  uint16_t i;
+
+  for (i = 0; i < strip.numberOfPixels; i++)
+    setPixelColor(&strip, i, 0x123456);
+}
+
+
+static void benchSetPixelStrided(void)
+{
+  uint16_t i;
+
+  for (i = 0; i < strip.numberOfPixels; i += 3)
+    setPixelColor(&strip, i, 0x123456);
+}
+
+
+static void benchSetPixelBlit(void)
+{
+  uint16_t i;
+
+  for (i = 0; i < strip.numberOfPixels; i++)
+    setPixelColor(&strip, i, benchPolice[i & 1]);
+}
+
+
+static void benchFillPixels(void)   { fillPixels(&strip, 0, strip.numberOfPixels, 0x123456); }
+static void benchFillStrided(void)  { fillPixelsStrided(&strip, 0, 3, 0x123456); }
+static void benchBlitPixels(void)   { blitPixels(&strip, 0, strip.numberOfPixels, benchPolice, 2); }
+
+
+static void benchPrimitive(const char *name, void (*primitive)(void), void (*loop)(void))
+{
+  double fast = benchCycles(primitive, NULL, 512);
+  double slow = benchCycles(loop, NULL, 512);
+  char label[32];
+
+  snprintf(label, sizeof(label), "%s, %u px", name, strip.numberOfPixels);
+  benchBudget(label, fast, slow * 1.25);
+  printf("     %.1f x the setPixelColor() loop (%.0f cycles)\n", slow / fast, slow);
+}
+
+
+static void benchPrimitives(void)
+{
+  static const uint16_t lengths[] = { 8, 16, NUMBER_OF_PIXELS };
+  uint8_t l;
+
+  for (l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+  {
+    create(&strip, lengths[l]);
+    setBrightness(&strip, 64);
+    benchPrimitive("fillPixels()", benchFillPixels, benchSetPixelFill);
+    benchPrimitive("fillPixelsStrided()", benchFillStrided, benchSetPixelStrided);
+    benchPrimitive("blitPixels()", benchBlitPixels, benchSetPixelBlit);
+  }
+}
+
+
+static const struct {
+  const char *name;
+  void (*run)(void);
+} benchSections[] = {
+  { "effects", benchEffects },
+  { "colormath", benchColormath },
+  { "primitives", benchPrimitives },
+};
+
+#define BENCH_SECTIONS  (sizeof(benchSections) / sizeof(benchSections[0]))
+
+
+int main(int argc, char *argv[])
+{
+  unsigned i;
+
+  for (i = 0; i < BENCH_SECTIONS; i++)
+  {
+    if ((argc > 1) && strcmp(argv[1], benchSections[i].name))
+      continue;
+    printf("# %s\n", benchSections[i].name);
+    benchSections[i].run();
+  }
+  return (benchFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,658 @@
+/*
+ * host.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * A virtual MSP430F2272 for running the firmware on a PC.
+ *
+ * Virtual time only moves when the firmware spends it: __delay_cycles(),
+ * _no_operation(), port accesses, interrupt entry, and sleeping in LPM0
+ * (which jumps straight to the next event.)  C code in between takes no
+ * time at all, so the timings here are those of show(), the sync line and
+ * the sleeps, not of the render code.  That is what makes a replay bit
+ * exact and repeatable.
+ *
+ * MODELLED:
+ *  - Status register: GIE and CPUOFF.  Pending interrupts are taken as
+ *    soon as GIE is set, highest priority first, with the SR saved and
+ *    restored around them, so __bic_SR_register_on_exit() and nesting work.
+ *  - Timer_B free running from SMCLK/8 (TBR = cycles / 8): overflow flag,
+ *    CCR0 compare and CCR1 capture (with COV), and TBIV.
+ *  - P1OUT SERIAL_OUTPUT_PIN: every edge is timed and decoded back into
+ *    bytes and frames like the LEDs would (hostOnFrame.)
+ *  - P2OUT/P2IN SYNC_PIN, with a Hi/Lo edge setting P2IFG.
+ *  - UCB0RXBUF and TACCTL2 call back into the test, which models the bus
+ *    or the clocks behind them.
+ *
+ * NOT MODELLED: anything else the peripherals do, TBCLR (TBR is always
+ * cycles / 8) and the watchdog.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <msp430f2272.h>
+#include "main.h"
+#include "sync.h"
+#include "ramcheck.h"
+
+#define HOST_MAX_EVENTS   8192
+#define HOST_MAX_NESTING  8
+#define HOST_OVERFLOW_CYCLES  (65536ULL * 8)
+
+//******************************************************************************
+//   REGISTERS
+//******************************************************************************
+
+volatile uint16_t WDTCTL;
+volatile uint8_t IE1, IFG1, IE2, IFG2;
+volatile uint8_t DCOCTL, BCSCTL1, BCSCTL2, BCSCTL3;
+volatile uint8_t CALDCO_16MHZ = 0x8F, CALBC1_16MHZ = 0x8F;
+volatile uint8_t P1IN, P1DIR, P1REN, P1SEL, P1IE, P1IES, P1IFG;
+volatile uint8_t P2DIR, P2REN, P2SEL, P2IE, P2IES, P2IFG;
+volatile uint8_t P3OUT, P3DIR, P3REN, P3SEL;
+volatile uint8_t P4OUT, P4DIR, P4REN, P4SEL;
+volatile uint16_t TACTL, TAR, TACCTL0, TACCTL1, TACCR0, TACCR1, TACCR2;
+volatile uint16_t TBCTL, TBCCTL0, TBCCTL1, TBCCR0, TBCCR1;
+volatile uint16_t ADC10CTL0, ADC10CTL1, ADC10SA, ADC10MEM;
+volatile uint8_t ADC10DTC0, ADC10DTC1, ADC10AE0;
+volatile uint8_t UCB0CTL0, UCB0CTL1, UCB0BR0, UCB0BR1, UCB0STAT, UCB0TXBUF, UCB0I2CIE;
+volatile uint16_t UCB0I2COA, UCB0I2CSA;
+
+static volatile uint16_t hostTACCTL2Value;
+
+// Linker symbols ramcheck.c reads, see msp430f2272.h.
+#define HOST_RAM_WORDS  256
+static uint16_t hostRam[HOST_RAM_WORDS];
+uint16_t *hostRamStart, *hostRamStaticEnd, *hostStackEnd;
+
+//******************************************************************************
+//   STATE
+//******************************************************************************
+
+uint64_t hostCycles;
+uint32_t hostInterruptLatency;
+uint64_t hostTimeLimit;
+void (*hostOnFrame)(const struct HostFrame *frame);
+void (*hostTimerACapture)(volatile uint16_t *tacctl2);
+void (*hostOnI2cRead)(void);
+uint8_t hostI2cData;
+void (*hostOnSyncOut)(bool level, uint64_t cycle);
+
+static uint16_t hostSR;
+static uint16_t hostSaved[HOST_MAX_NESTING];
+static uint8_t hostDepth;
+uint8_t hostDeepestNesting;
+static uint64_t hostLastOverflow, hostLastCompare;
+
+// Scheduled inputs, sorted by cycle (then by when they were scheduled.)
+struct HostScheduled {
+  uint64_t cycle;
+  HostEvent event;
+  uint32_t arg;
+};
+static struct HostScheduled hostQueue[HOST_MAX_EVENTS];
+static uint16_t hostQueued;
+
+// An output pin.  A write is only seen on the next access (or hostFlush()),
+// which is when we know it happened at 'written'.
+struct HostPort {
+  volatile uint8_t value;
+  uint8_t seen;
+  uint8_t pin;
+  uint8_t bitTest;      // Cycles before a write that raises the pin.
+  uint64_t written;
+  void (*edge)(bool level, uint64_t cycle);
+};
+
+static void hostSerialEdge(bool level, uint64_t cycle);
+static void hostSyncEdge(bool level, uint64_t cycle);
+
+static struct HostPort hostPort1 = { 0, 0, SERIAL_OUTPUT_PIN, HOST_BIT_TEST_CYCLES, 0, hostSerialEdge };
+static struct HostPort hostPort2 = { 0, 0, SYNC_PIN, 0, 0, hostSyncEdge };
+static bool hostSyncLine = true;  // Idle high.
+
+// Serial data decoder.
+static struct HostFrame hostFrame;
+static bool hostInFrame;
+static uint64_t hostLastRise, hostLastFall;
+
+static uint64_t hostNextEvent(uint64_t limit);
+static void hostEvents(void);
+static void hostInterrupts(void);
+
+//******************************************************************************
+//   CONTROL
+//******************************************************************************
+
+// Power on: time 0, interrupts off, nothing pending.
+void hostReset(void)
+{
+  uint16_t i;
+
+  hostCycles = 0;
+  hostSR = 0;
+  hostDepth = 0;
+  hostDeepestNesting = 0;
+  hostLastOverflow = 0;
+  hostLastCompare = 0;
+  hostQueued = 0;
+  hostInterruptLatency = 0;
+  hostTimeLimit = 600ULL * 1000 * HOST_CYCLES_PER_MS;  // 10 minutes.
+
+  TBCTL = 0;
+  TBCCTL0 = 0;
+  TBCCTL1 = 0;
+  TACTL = 0;
+  hostTACCTL2Value = 0;
+  P1IFG = 0;
+  P2IFG = 0;
+  IFG2 = 0;
+  UCB0STAT = 0;
+  UCB0I2CIE = 0;
+  ADC10CTL0 = 0;
+
+  // Painted and never touched: all headroom, no stack.
+  for (i = 0; i < HOST_RAM_WORDS; i++)
+    hostRam[i] = RAM_PAINT;
+  hostRamStart = hostRamStaticEnd = hostRam;
+  hostStackEnd = hostRam + HOST_RAM_WORDS;
+
+  hostPort1.value = hostPort1.seen = 0;
+  hostPort2.value = hostPort2.seen = SYNC_PIN;
+  hostSyncLine = true;
+  hostInFrame = false;
+  hostLastRise = 0;
+  hostLastFall = 0;
+}
+
+
+void hostFail(const char *format, ...)
+{
+  va_list args;
+
+  fprintf(stderr, "FAIL at %lluus: ", (unsigned long long)(hostCycles / HOST_CYCLES_PER_US));
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fprintf(stderr, "\n");
+  exit(1);
+}
+
+
+// Call event(arg) at 'cycle'.
+void hostSchedule(uint64_t cycle, HostEvent event, uint32_t arg)
+{
+  uint16_t i = hostQueued;
+
+  if (hostQueued == HOST_MAX_EVENTS)
+    hostFail("too many scheduled events");
+  while ((i != 0) && (hostQueue[i - 1].cycle > cycle))
+  {
+    hostQueue[i] = hostQueue[i - 1];
+    i--;
+  }
+  hostQueue[i].cycle = cycle;
+  hostQueue[i].event = event;
+  hostQueue[i].arg = arg;
+  hostQueued++;
+}
+
+
+// Let 'cycles' go by, taking any interrupts that come up if GIE is set.
+void hostAdvance(uint32_t cycles)
+{
+  hostRunUntil(hostCycles + cycles);
+}
+
+
+void hostRunUntil(uint64_t cycle)
+{
+  while (hostCycles < cycle)
+  {
+    hostCycles = hostNextEvent(cycle);
+    hostEvents();
+    hostInterrupts();
+  }
+}
+
+
+// See the last port writes, and finish the frame on the serial line.
+void hostFlush(void)
+{
+  if ((hostPort1.value ^ hostPort1.seen) & hostPort1.pin)
+    hostSerialEdge((hostPort1.value & hostPort1.pin) != 0, hostPort1.written);
+  hostPort1.seen = hostPort1.value;
+  if ((hostPort2.value ^ hostPort2.seen) & hostPort2.pin)
+    hostSyncEdge((hostPort2.value & hostPort2.pin) != 0, hostPort2.written);
+  hostPort2.seen = hostPort2.value;
+
+  if (hostInFrame && ((hostPort1.value & hostPort1.pin) == 0))
+  {
+    hostInFrame = false;
+    if (hostOnFrame)
+      hostOnFrame(&hostFrame);
+  }
+}
+
+//******************************************************************************
+//   INPUTS, for hostSchedule()
+//******************************************************************************
+
+// IR receiver output changed: Timer_B CCR1 captures TBR.
+void hostIrEdge(uint32_t level)
+{
+  (void)level;
+  if ((TBCCTL1 & CAP) == 0)
+    return;
+  if (TBCCTL1 & CCIFG)
+    TBCCTL1 |= COV;
+  TBCCR1 = (uint16_t)(hostCycles >> 3);
+  TBCCTL1 |= CCIFG;
+}
+
+
+// Sync line driven to 'level' by the master.
+void hostSyncLevel(uint32_t level)
+{
+  bool falling = hostSyncLine && (level == 0);
+  bool rising = (hostSyncLine == false) && (level != 0);
+
+  hostSyncLine = (level != 0);
+  if ((P2IES & SYNC_PIN) ? falling : rising)
+    P2IFG |= SYNC_PIN;
+}
+
+
+// The bus controller has shifted a byte into UCB0RXBUF.
+void hostI2cByte(uint32_t data)
+{
+  hostI2cData = (uint8_t)data;
+  if (data & HOST_I2C_START)
+    UCB0STAT |= UCSTTIFG;
+  IFG2 |= UCB0RXIFG;
+}
+
+
+// The bus controller has sent a START and our address.
+void hostI2cStart(uint32_t unused)
+{
+  UCB0STAT |= UCSTTIFG;
+}
+
+
+// The bus controller has sent a STOP.
+void hostI2cStop(uint32_t unused)
+{
+  UCB0STAT |= UCSTPIFG;
+}
+
+
+// Set the flag behind 'vector', as if its peripheral had asked.
+void hostRaise(uint32_t vector)
+{
+  switch (vector)
+  {
+    case PORT1_VECTOR:      P1IFG |= P1IE;        break;
+    case PORT2_VECTOR:      P2IFG |= P2IE;        break;
+    case ADC10_VECTOR:      ADC10CTL0 |= ADC10IFG; break;
+    case USCIAB0TX_VECTOR:  IFG2 |= UCB0TXIFG;    break;
+    case TIMERB0_VECTOR:    TBCCTL0 |= CCIFG;     break;
+    case TIMERB1_VECTOR:    TBCTL |= TBIFG;       break;
+  }
+  hostInterrupts();
+}
+
+//******************************************************************************
+//   REGISTER MODELS
+//******************************************************************************
+
+// Output port access: the write lands HOST_PORT_WRITE_CYCLES from now
+// (plus the bit test in front of a rising edge.)
+static volatile uint8_t *hostPortAccess(struct HostPort *port)
+{
+  uint32_t cycles = HOST_PORT_WRITE_CYCLES;
+
+  if ((port->value & port->pin) == 0)
+    cycles += port->bitTest;
+  hostAdvance(cycles);
+
+  if ((port->value ^ port->seen) & port->pin)
+    port->edge((port->value & port->pin) != 0, port->written);
+  port->seen = port->value;
+  port->written = hostCycles;
+  return &port->value;
+}
+
+
+volatile uint8_t *hostP1OUT(void)
+{
+  return hostPortAccess(&hostPort1);
+}
+
+
+volatile uint8_t *hostP2OUT(void)
+{
+  return hostPortAccess(&hostPort2);
+}
+
+
+uint8_t hostP2IN(void)
+{
+  hostAdvance(HOST_PORT_READ_CYCLES);
+  return hostSyncLine ? SYNC_PIN : 0;
+}
+
+
+volatile uint16_t *hostTACCTL2(void)
+{
+  if (hostTimerACapture)
+    hostTimerACapture(&hostTACCTL2Value);
+  return &hostTACCTL2Value;
+}
+
+
+uint16_t hostTBR(void)
+{
+  return (uint16_t)(hostCycles >> 3);
+}
+
+
+// Reading TBIV clears the flag it reports.
+uint16_t hostTBIV(void)
+{
+  if ((TBCCTL1 & (CCIE | CCIFG)) == (CCIE | CCIFG))
+  {
+    TBCCTL1 &= ~CCIFG;
+    return 0x02;
+  }
+  if ((TBCTL & (TBIE | TBIFG)) == (TBIE | TBIFG))
+  {
+    TBCTL &= ~TBIFG;
+    return 0x0E;
+  }
+  return 0;
+}
+
+
+uint8_t hostUCB0RXBUF(void)
+{
+  uint8_t value = hostI2cData;
+
+  IFG2 &= ~UCB0RXIFG;
+  if (hostOnI2cRead)
+    hostOnI2cRead();
+  return value;
+}
+
+//******************************************************************************
+//   SERIAL DATA DECODER
+//******************************************************************************
+
+static void hostSerialEdge(bool level, uint64_t cycle)
+{
+  uint64_t low;
+
+  if (level)
+  {
+    low = cycle - hostLastFall;
+    if (hostInFrame && (low >= HOST_RESET_CYCLES))
+    {
+      hostInFrame = false;
+      if (hostOnFrame)
+        hostOnFrame(&hostFrame);
+    }
+    if (hostInFrame == false)
+    {
+      memset(&hostFrame, 0, sizeof(hostFrame));
+      hostFrame.start = cycle;
+      hostFrame.reset = (uint32_t)low;
+      hostInFrame = true;
+    }
+    else if (low > hostFrame.longestLow)
+    {
+      hostFrame.longestLow = (uint32_t)low;
+    }
+    hostLastRise = cycle;
+  }
+  else
+  {
+    hostLastFall = cycle;
+    if (hostInFrame == false)
+      return;
+    if (hostFrame.bytes == HOST_MAX_FRAME_BYTES)
+      hostFail("frame longer than %d bytes", HOST_MAX_FRAME_BYTES);
+    hostFrame.data[hostFrame.bytes] <<= 1;
+    if ((cycle - hostLastRise) > HOST_ONE_CYCLES)
+      hostFrame.data[hostFrame.bytes] |= 1;
+    if (++hostFrame.bits == 8)
+    {
+      hostFrame.bits = 0;
+      hostFrame.bytes++;
+    }
+    hostFrame.end = cycle;
+  }
+}
+
+
+static void hostSyncEdge(bool level, uint64_t cycle)
+{
+  if (hostOnSyncOut)
+    hostOnSyncOut(level, cycle);
+}
+
+//******************************************************************************
+//   CPU
+//******************************************************************************
+
+extern void Timer_B0(void) __attribute__((weak));
+extern void Timer_B1(void) __attribute__((weak));
+extern void USCIAB0TX_ISR(void) __attribute__((weak));
+extern void USCIAB0RX_ISR(void) __attribute__((weak));
+extern void ADC10_ISR(void) __attribute__((weak));
+extern void Port_2(void) __attribute__((weak));
+extern void Port_1(void) __attribute__((weak));
+
+
+// Earliest of 'limit', a Timer_B event and a scheduled input.
+static uint64_t hostNextEvent(uint64_t limit)
+{
+  uint64_t next = limit, at, tick;
+  uint32_t ahead;
+
+  if (TBCTL & MC_3)
+  {
+    at = ((hostCycles / HOST_OVERFLOW_CYCLES) + 1) * HOST_OVERFLOW_CYCLES;
+    if (at < next)
+      next = at;
+
+    if ((TBCCTL0 & (CCIE | CCIFG | CAP)) == CCIE)
+    {
+      tick = hostCycles >> 3;
+      ahead = (uint16_t)(TBCCR0 - (uint16_t)tick);
+      if (ahead == 0)
+        ahead = 65536;
+      at = (tick + ahead) << 3;
+      if (at < next)
+        next = at;
+    }
+  }
+
+  if ((hostQueued != 0) && (hostQueue[0].cycle < next))
+    next = (hostQueue[0].cycle > hostCycles) ? hostQueue[0].cycle : hostCycles;
+
+  if ((hostTimeLimit != 0) && (next > hostTimeLimit))
+    hostFail("still running after %llums", (unsigned long long)(hostTimeLimit / HOST_CYCLES_PER_MS));
+  return next;
+}
+
+
+// Whatever happens at hostCycles.
+static void hostEvents(void)
+{
+  uint16_t i;
+
+  if ((TBCTL & MC_3) && ((hostCycles % HOST_OVERFLOW_CYCLES) == 0)
+      && (hostCycles != hostLastOverflow))
+  {
+    hostLastOverflow = hostCycles;
+    TBCTL |= TBIFG;
+  }
+  if ((TBCTL & MC_3) && ((TBCCTL0 & (CCIE | CAP)) == CCIE) && ((hostCycles & 7) == 0)
+      && ((uint16_t)(hostCycles >> 3) == TBCCR0) && (hostCycles != hostLastCompare))
+  {
+    hostLastCompare = hostCycles;
+    TBCCTL0 |= CCIFG;
+  }
+
+  while ((hostQueued != 0) && (hostQueue[0].cycle <= hostCycles))
+  {
+    struct HostScheduled due = hostQueue[0];
+    hostQueued--;
+    for (i = 0; i < hostQueued; i++)
+      hostQueue[i] = hostQueue[i + 1];
+    due.event(due.arg);
+  }
+}
+
+
+// USCIAB0TX_ISR(), with the UCB0TXBUF write clearing UCB0TXIFG before the
+// reti, which would otherwise take it again.
+static void hostUsciTx(void)
+{
+  bool transmit = ((IE2 & UCB0RXIE) && (IFG2 & UCB0RXIFG)) == 0;
+
+  USCIAB0TX_ISR();
+  if (transmit)
+    IFG2 &= ~UCB0TXIFG;
+}
+
+
+// Run one ISR like the hardware: save the SR, clear it, reti restores it.
+static void hostInterrupt(void (*isr)(void), const char *name)
+{
+  if (isr == 0)
+    hostFail("%s interrupt with no ISR linked", name);
+  if (hostDepth == HOST_MAX_NESTING)
+    hostFail("interrupts nested more than %d deep", HOST_MAX_NESTING);
+
+  hostSaved[hostDepth++] = hostSR;
+  if (hostDepth > hostDeepestNesting)
+    hostDeepestNesting = hostDepth;
+  hostSR = 0;
+  hostAdvance(HOST_INTERRUPT_CYCLES + hostInterruptLatency);
+  isr();
+  hostSR = hostSaved[--hostDepth];
+  hostAdvance(HOST_RETI_CYCLES);
+}
+
+
+// Take pending interrupts, highest priority first, while GIE is set.
+static void hostInterrupts(void)
+{
+  while (hostSR & GIE)
+  {
+    if ((TBCCTL0 & (CCIE | CCIFG)) == (CCIE | CCIFG))
+    {
+      TBCCTL0 &= ~CCIFG;  // Single source, cleared on entry.
+      hostInterrupt(Timer_B0, "Timer_B0");
+    }
+    else if (((TBCCTL1 & (CCIE | CCIFG)) == (CCIE | CCIFG))
+             || ((TBCTL & (TBIE | TBIFG)) == (TBIE | TBIFG)))
+    {
+      hostInterrupt(Timer_B1, "Timer_B1");
+    }
+    else if (UCB0I2CIE & UCB0STAT & (UCSTPIFG | UCSTTIFG))
+    {
+      hostInterrupt(USCIAB0RX_ISR, "USCIAB0RX");
+    }
+    else if (((IE2 & UCB0RXIE) && (IFG2 & UCB0RXIFG)) || ((IE2 & UCB0TXIE) && (IFG2 & UCB0TXIFG)))
+    {
+      hostInterrupt(USCIAB0TX_ISR ? hostUsciTx : 0, "USCIAB0TX");
+    }
+    else if ((ADC10CTL0 & (ADC10IE | ADC10IFG)) == (ADC10IE | ADC10IFG))
+    {
+      ADC10CTL0 &= ~ADC10IFG;
+      hostInterrupt(ADC10_ISR, "ADC10");
+    }
+    else if (P2IE & P2IFG)
+    {
+      hostInterrupt(Port_2, "Port_2");
+    }
+    else if (P1IE & P1IFG)
+    {
+      hostInterrupt(Port_1, "Port_1");
+    }
+    else
+    {
+      return;
+    }
+  }
+}
+
+//******************************************************************************
+//   INTRINSICS
+//******************************************************************************
+
+void __bic_SR_register(uint16_t bits)
+{
+  hostSR &= ~bits;
+}
+
+
+// Setting CPUOFF sleeps until an ISR clears it on exit.
+void __bis_SR_register(uint16_t bits)
+{
+  hostSR |= bits;
+  hostInterrupts();
+  while (hostSR & CPUOFF)
+  {
+    hostCycles = hostNextEvent(UINT64_MAX);
+    if (hostCycles == UINT64_MAX)
+      hostFail("asleep with nothing to wake us");
+    hostEvents();
+    hostInterrupts();
+  }
+}
+
+
+void __bic_SR_register_on_exit(uint16_t bits)
+{
+  if (hostDepth == 0)
+    hostFail("__bic_SR_register_on_exit() outside an ISR");
+  hostSaved[hostDepth - 1] &= ~bits;
+}
+
+
+void __bis_SR_register_on_exit(uint16_t bits)
+{
+  if (hostDepth == 0)
+    hostFail("__bis_SR_register_on_exit() outside an ISR");
+  hostSaved[hostDepth - 1] |= bits;
+}
+
+
+uint16_t __get_SR_register(void)
+{
+  return hostSR;
+}
+
+
+uintptr_t __get_SP_register(void)
+{
+  return (uintptr_t)__builtin_frame_address(0);
+}
+
+
+void __delay_cycles(uint32_t cycles)
+{
+  hostAdvance(cycles);
+}
+
+
+void __no_operation(void)
+{
+  hostAdvance(1);
+}
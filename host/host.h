@@ -0,0 +1,115 @@
+/*
+ * host.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ */
+
+#ifndef HOST_H_
+#define HOST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// The virtual MCU clock: MCLK = SMCLK = 16MHz, Timer_B at SMCLK/8.
+#define HOST_CYCLES_PER_US     16
+#define HOST_CYCLES_PER_MS     16000
+
+// Serial data decoding.  A high longer than HOST_ONE_CYCLES is a 1, a low of
+// HOST_RESET_CYCLES (50us) or more ends a frame.
+#define HOST_ONE_CYCLES        8
+#define HOST_RESET_CYCLES      800
+#define HOST_MAX_FRAME_BYTES   (3 * 1024)
+
+// Pin write timing, calibrated against the scope measurements in
+// WS2812B_Strip.c: a port write lands 5 cycles after it starts, and the bit
+// test and branch in front of every rising edge takes another 6.
+#define HOST_PORT_WRITE_CYCLES 5
+#define HOST_BIT_TEST_CYCLES   6
+#define HOST_PORT_READ_CYCLES  5
+
+// Interrupt acceptance and reti.
+#define HOST_INTERRUPT_CYCLES  6
+#define HOST_RETI_CYCLES       5
+
+// One frame as the LEDs saw it on SERIAL_OUTPUT_PIN.
+struct HostFrame {
+  uint64_t start;          // Cycle of the first rising edge.
+  uint64_t end;            // Cycle of the last falling edge.
+  uint32_t reset;          // Low before the first bit, HOST_RESET_CYCLES+.
+  uint32_t longestLow;     // Longest low between two bits of the frame.
+  uint16_t bytes;          // Whole bytes received, GRB order like pixels[].
+  uint8_t  bits;           // Bits left over, should be 0.
+  uint8_t  data[HOST_MAX_FRAME_BYTES];
+};
+
+// Scheduled input, called at 'cycle' with 'arg'.
+typedef void (*HostEvent)(uint32_t arg);
+
+// Virtual time in MCLK cycles since hostReset().
+extern uint64_t hostCycles;
+
+// Extra cycles taken by every interrupt entry, on top of
+// HOST_INTERRUPT_CYCLES.  Tests use it for prologues and wake up time.
+extern uint32_t hostInterruptLatency;
+
+// Most interrupts nested at once since hostReset().
+extern uint8_t hostDeepestNesting;
+
+// Give up (hostFail()) if virtual time passes this.  0 = never.
+extern uint64_t hostTimeLimit;
+
+// Called with every frame decoded from SERIAL_OUTPUT_PIN.
+extern void (*hostOnFrame)(const struct HostFrame *frame);
+
+// Called whenever the firmware reads TACCTL2, so a test can model what the
+// capture would have seen (set CCIFG and TACCR2.)  See test_dco.c.
+extern void (*hostTimerACapture)(volatile uint16_t *tacctl2);
+
+// Called whenever the firmware reads UCB0RXBUF (which clears UCB0RXIFG),
+// so a test can clock the next byte in (hostI2cByte().)  See test_i2c.c.
+extern void (*hostOnI2cRead)(void);
+extern uint8_t hostI2cData;
+
+// Called with each new level of P2OUT's SYNC_PIN and when it changed.
+extern void (*hostOnSyncOut)(bool level, uint64_t cycle);
+
+void hostReset(void);
+void hostFail(const char *format, ...);
+void hostSchedule(uint64_t cycle, HostEvent event, uint32_t arg);
+void hostAdvance(uint32_t cycles);
+void hostRunUntil(uint64_t cycle);
+void hostFlush(void);
+
+// Input events for hostSchedule().
+void hostIrEdge(uint32_t level);
+void hostSyncLevel(uint32_t level);
+void hostRaise(uint32_t vector);
+void hostI2cByte(uint32_t data);
+void hostI2cStart(uint32_t unused);
+void hostI2cStop(uint32_t unused);
+
+// hostI2cByte(): data is the byte, plus this if it is the first after a
+// START.
+#define HOST_I2C_START  0x100
+
+// Register models, see msp430f2272.h.
+volatile uint8_t *hostP1OUT(void);
+volatile uint8_t *hostP2OUT(void);
+uint8_t hostP2IN(void);
+volatile uint16_t *hostTACCTL2(void);
+uint16_t hostTBR(void);
+uint16_t hostTBIV(void);
+uint8_t hostUCB0RXBUF(void);
+
+// CPU intrinsics.
+void __bic_SR_register(uint16_t bits);
+void __bis_SR_register(uint16_t bits);
+void __bic_SR_register_on_exit(uint16_t bits);
+void __bis_SR_register_on_exit(uint16_t bits);
+uint16_t __get_SR_register(void);
+uintptr_t __get_SP_register(void);
+void __delay_cycles(uint32_t cycles);
+void __no_operation(void);
+
+#endif /* HOST_H_ */
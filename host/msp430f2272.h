@@ -0,0 +1,244 @@
+/*
+ * msp430f2272.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * Host build stand in for TI's register header.  Found before the real
+ * one because host/ is first on the include path (see host/Makefile.)
+ *
+ * Most registers are plain variables.  The ones with behaviour (the free
+ * running Timer_B, the serial data pin, the sync line, the I2C receive
+ * buffer, the DCO measurement capture) go through host.c so the virtual
+ * CPU can model them.  Bit values are the real ones.
+ */
+
+#ifndef MSP430F2272_H_
+#define MSP430F2272_H_
+
+#include <stdint.h>
+#include "host.h"
+
+//******************************************************************************
+//   INTRINSICS (host.c)
+//******************************************************************************
+
+#define __interrupt
+#define _no_operation()   __no_operation()
+
+// Code whose cycles matter between two port writes says what it costs on
+// the F2272 (see transmit()), the host charges it like a delay.
+#define CODE_CYCLES(cycles)  __delay_cycles(cycles)
+
+//******************************************************************************
+//   REGISTERS
+//******************************************************************************
+
+#define HOST_REG8(name)   extern volatile uint8_t name;
+#define HOST_REG16(name)  extern volatile uint16_t name;
+
+HOST_REG16(WDTCTL)
+HOST_REG8(IE1)
+HOST_REG8(IFG1)
+HOST_REG8(IE2)
+HOST_REG8(IFG2)
+
+// Basic clock.  CALDCO/CALBC1 are info flash on the real part.
+HOST_REG8(DCOCTL)
+HOST_REG8(BCSCTL1)
+HOST_REG8(BCSCTL2)
+HOST_REG8(BCSCTL3)
+HOST_REG8(CALDCO_16MHZ)
+HOST_REG8(CALBC1_16MHZ)
+
+// Ports.  P1OUT (SERIAL_OUTPUT_PIN) and P2OUT/P2IN (SYNC_PIN) are modelled.
+#define P1OUT  (*hostP1OUT())
+HOST_REG8(P1IN)
+HOST_REG8(P1DIR)
+HOST_REG8(P1REN)
+HOST_REG8(P1SEL)
+HOST_REG8(P1IE)
+HOST_REG8(P1IES)
+HOST_REG8(P1IFG)
+#define P2OUT  (*hostP2OUT())
+#define P2IN   (hostP2IN())
+HOST_REG8(P2DIR)
+HOST_REG8(P2REN)
+HOST_REG8(P2SEL)
+HOST_REG8(P2IE)
+HOST_REG8(P2IES)
+HOST_REG8(P2IFG)
+HOST_REG8(P3OUT)
+HOST_REG8(P3DIR)
+HOST_REG8(P3REN)
+HOST_REG8(P3SEL)
+HOST_REG8(P4OUT)
+HOST_REG8(P4DIR)
+HOST_REG8(P4REN)
+HOST_REG8(P4SEL)
+
+// Timer_A.  TACCTL2/TACCR2 can be driven by a clock model, see test_dco.c.
+HOST_REG16(TACTL)
+HOST_REG16(TAR)
+HOST_REG16(TACCTL0)
+HOST_REG16(TACCTL1)
+#define TACCTL2  (*hostTACCTL2())
+HOST_REG16(TACCR0)
+HOST_REG16(TACCR1)
+HOST_REG16(TACCR2)
+
+// Timer_B.  TBR counts SMCLK/8 off the virtual clock.
+HOST_REG16(TBCTL)
+#define TBR   (hostTBR())
+#define TBIV  (hostTBIV())
+HOST_REG16(TBCCTL0)
+HOST_REG16(TBCCTL1)
+HOST_REG16(TBCCR0)
+HOST_REG16(TBCCR1)
+
+// ADC10
+HOST_REG16(ADC10CTL0)
+HOST_REG16(ADC10CTL1)
+HOST_REG8(ADC10DTC0)
+HOST_REG8(ADC10DTC1)
+HOST_REG8(ADC10AE0)
+HOST_REG16(ADC10SA)
+HOST_REG16(ADC10MEM)
+
+// USCI_B0
+HOST_REG8(UCB0CTL0)
+HOST_REG8(UCB0CTL1)
+HOST_REG8(UCB0BR0)
+HOST_REG8(UCB0BR1)
+HOST_REG8(UCB0STAT)
+HOST_REG8(UCB0I2CIE)
+HOST_REG16(UCB0I2COA)
+HOST_REG16(UCB0I2CSA)
+#define UCB0RXBUF  (hostUCB0RXBUF())
+HOST_REG8(UCB0TXBUF)
+
+//******************************************************************************
+//   BITS
+//******************************************************************************
+
+#define BIT0  0x01
+#define BIT1  0x02
+#define BIT2  0x04
+#define BIT3  0x08
+#define BIT4  0x10
+#define BIT5  0x20
+#define BIT6  0x40
+#define BIT7  0x80
+
+// Status register
+#define GIE        0x0008
+#define CPUOFF     0x0010
+#define OSCOFF     0x0020
+#define SCG0       0x0040
+#define SCG1       0x0080
+#define LPM0_bits  (CPUOFF)
+#define LPM3_bits  (SCG1 | SCG0 | CPUOFF)
+
+// Watchdog
+#define WDTPW    0x5A00
+#define WDTHOLD  0x0080
+
+// Special function registers
+#define OFIFG      0x02
+#define UCB0RXIE   0x04
+#define UCB0TXIE   0x08
+#define UCB0RXIFG  0x04
+#define UCB0TXIFG  0x08
+
+// Basic clock
+#define RSEL0      0x01
+#define RSEL1      0x02
+#define RSEL2      0x04
+#define RSEL3      0x08
+#define XT2OFF     0x80
+#define DIVA_0     0x00
+#define DIVA_3     0x30
+#define LFXT1OF    0x01
+#define LFXT1S_0   0x00
+#define XCAP_3     0x0C
+
+// Timer_A / Timer_B control
+#define TASSEL_2   0x0200
+#define TBSSEL_2   0x0200
+#define ID_3       0x00C0
+#define MC_0       0x0000
+#define MC_1       0x0010
+#define MC_2       0x0020
+#define MC_3       0x0030
+#define TACLR      0x0004
+#define TBCLR      0x0004
+#define TAIE       0x0002
+#define TBIE       0x0002
+#define TAIFG      0x0001
+#define TBIFG      0x0001
+
+// Capture/compare control
+#define CM_1       0x4000
+#define CM_2       0x8000
+#define CM_3       0xC000
+#define CCIS_0     0x0000
+#define CCIS_1     0x1000
+#define SCS        0x0800
+#define CAP        0x0100
+#define OUTMOD_3   0x0060
+#define CCIE       0x0010
+#define CCI        0x0008
+#define COV        0x0002
+#define CCIFG      0x0001
+
+// ADC10
+#define SREF_0       0x0000
+#define ADC10SHT_2   0x1000
+#define ADC10ON      0x0010
+#define ADC10IE      0x0008
+#define ADC10IFG     0x0004
+#define ENC          0x0002
+#define ADC10SC      0x0001
+#define INCH_0       0x0000
+#define SHS_1        0x0400
+#define ADC10DIV_3   0x0060
+#define ADC10SSEL_3  0x0018
+#define CONSEQ_2     0x0004
+#define ADC10TB      0x08
+#define ADC10CT      0x04
+#define ADC10B1      0x02
+
+// USCI_B0 I2C
+#define UCMODE_3   0x06
+#define UCSYNC     0x01
+#define UCSWRST    0x01
+#define UCSTTIFG   0x02
+#define UCSTPIFG   0x04
+#define UCSTTIE    0x02
+#define UCSTPIE    0x04
+
+//******************************************************************************
+//   VECTORS (only used by the ignored #pragma vector)
+//******************************************************************************
+
+#define PORT1_VECTOR      4
+#define PORT2_VECTOR      6
+#define USCIAB0TX_VECTOR  12
+#define USCIAB0RX_VECTOR  14
+#define ADC10_VECTOR      10
+#define TIMERB0_VECTOR    26
+#define TIMERB1_VECTOR    24
+
+//******************************************************************************
+//   LINKER SYMBOLS (ramcheck.c)
+//******************************************************************************
+
+// The RAM ramcheck.c measures: hostRam[] by default, which is never stack.
+// A test that runs the firmware on a stack of its own points these at it,
+// see test_ramcheck.c.
+extern uint16_t *hostRamStart, *hostRamStaticEnd, *hostStackEnd;
+#define RAM_START          ((uintptr_t)hostRamStart)
+#define __RAM_STATIC_END   (*hostRamStaticEnd)
+#define __STACK_END        (*hostStackEnd)
+
+#endif /* MSP430F2272_H_ */
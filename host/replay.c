@@ -0,0 +1,154 @@
+/*
+ * replay.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * Run one pattern on the virtual MCU (host.c) and print every frame the
+ * LEDs would have shown, decoded from the serial data pin:
+ *
+ *   replay <pattern> [image.ppm]
+ *
+ * One line per frame: the time it started in us, then each pixel as
+ * RRGGBB.  Frames that did not decode into whole pixels after a proper
+ * reset are marked BROKEN.  The frame pacing stats follow at the end.
+ * 'make test' diffs this against golden/<pattern>.txt.
+ *
+ * With an image file, every frame is also one row of a PPM, which is
+ * easier to look at than a wall of hex.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <msp430f2272.h>
+#include "main.h"
+#include "patterns.h"
+#include "effects.h"
+#include "matrix.h"
+#include "scheduler.h"
+#include "WS2812B_Strip.h"
+
+#define REPLAY_MAX_FRAMES  4096
+
+extern struct WS2812B_Strip strip;
+
+static uint8_t *replayImage;
+static uint16_t replayRows;
+
+// Same arguments as the main loop uses.
+static void replayColorWipe(void)           { testColor(&strip, 255, 0, 0, 1000); }
+static void replayPoliceLights(void)        { policeLights(&strip, 150); }
+static void replayRainbow(void)             { rainbow(&strip, 15); }
+static void replayRainbowCycle(void)        { rainbowCycle(&strip, 5); }
+static void replayTheaterChase(void)        { theaterChase(&strip, BLUE, 100); }
+static void replayTheaterChaseRainbow(void) { theaterChaseRainbow(&strip, 100); }
+static void replayBreathe(void)             { breathe(&strip, BLUE, 2000); }
+static void replayFire(void)                { fire(&strip, 55, 120, 15); }
+static void replayMeteorRain(void)          { meteorRain(&strip, color(0xFF, 0xFF, 0xFF), 0x1F, 30); }
+static void replaySparkle(void)             { sparkle(&strip, color(0xFF, 0xFF, 0xFF), 80, 20); }
+static void replayMatrixZones(void)         { matrixZones(&strip, 20); }
+
+static const struct {
+  const char *name;
+  void (*run)(void);
+} replayPatterns[] = {
+  { "colorWipe",           replayColorWipe },
+  { "policeLights",        replayPoliceLights },
+  { "rainbow",             replayRainbow },
+  { "rainbowCycle",        replayRainbowCycle },
+  { "theaterChase",        replayTheaterChase },
+  { "theaterChaseRainbow", replayTheaterChaseRainbow },
+  { "breathe",             replayBreathe },
+  { "fire",                replayFire },
+  { "meteorRain",          replayMeteorRain },
+  { "sparkle",             replaySparkle },
+  { "matrixZones",         replayMatrixZones },
+};
+
+#define REPLAY_PATTERNS  (sizeof(replayPatterns) / sizeof(replayPatterns[0]))
+
+
+static void replayFrame(const struct HostFrame *frame)
+{
+  uint16_t i;
+
+  printf("%9llu", (unsigned long long)(frame->start / HOST_CYCLES_PER_US));
+  for (i = 0; i + 2 < frame->bytes; i += 3)
+  {
+    printf(" %02X%02X%02X", frame->data[i + 1], frame->data[i], frame->data[i + 2]);
+  }
+  if ((frame->bits != 0) || (frame->bytes != 3 * NUMBER_OF_PIXELS) || (frame->reset < HOST_RESET_CYCLES))
+    printf(" BROKEN");
+  printf("\n");
+
+  if (replayImage && (replayRows < REPLAY_MAX_FRAMES))
+  {
+    uint8_t *row = &replayImage[(uint32_t)replayRows++ * 3 * NUMBER_OF_PIXELS];
+    for (i = 0; (i + 2 < frame->bytes) && (i < 3 * NUMBER_OF_PIXELS); i += 3)
+    {
+      row[i] = frame->data[i + 1];
+      row[i + 1] = frame->data[i];
+      row[i + 2] = frame->data[i + 2];
+    }
+  }
+}
+
+
+static void replayWriteImage(const char *file)
+{
+  FILE *image = fopen(file, "wb");
+
+  if (image == NULL)
+  {
+    perror(file);
+    exit(1);
+  }
+  fprintf(image, "P6\n%d %d\n255\n", NUMBER_OF_PIXELS, replayRows);
+  fwrite(replayImage, 3 * NUMBER_OF_PIXELS, replayRows, image);
+  fclose(image);
+}
+
+
+int main(int argc, char *argv[])
+{
+  unsigned i;
+
+  for (i = 0; i < REPLAY_PATTERNS; i++)
+  {
+    if ((argc > 1) && (strcmp(argv[1], replayPatterns[i].name) == 0))
+      break;
+  }
+  if (i == REPLAY_PATTERNS)
+  {
+    fprintf(stderr, "usage: replay <pattern> [image.ppm]\npatterns:");
+    for (i = 0; i < REPLAY_PATTERNS; i++)
+      fprintf(stderr, " %s", replayPatterns[i].name);
+    fprintf(stderr, "\n");
+    return 2;
+  }
+  if (argc > 2)
+    replayImage = calloc(REPLAY_MAX_FRAMES, 3 * NUMBER_OF_PIXELS);
+
+  printf("# %s, %d pixels: start (us) then RRGGBB per pixel for each frame\n",
+         replayPatterns[i].name, NUMBER_OF_PIXELS);
+
+  // As main(): 1.5 pixels off, 1.6 timebase, 2.0 interrupts on.
+  hostReset();
+  hostOnFrame = replayFrame;
+  create(&strip, NUMBER_OF_PIXELS);
+  show(&strip);
+  setBrightness(&strip, 64);
+  timebaseInit();
+  __bis_SR_register(GIE);
+
+  replayPatterns[i].run();
+  hostFlush();
+
+  printf("# framesShown %u framesDropped %u deadlinesMissed %u\n",
+         strip.frame.framesShown, strip.frame.framesDropped, strip.frame.deadlinesMissed);
+
+  if (replayImage)
+    replayWriteImage(argv[2]);
+  return 0;
+}
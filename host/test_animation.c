@@ -0,0 +1,204 @@
+/*
+ * test_animation.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * The time based patterns (animation.c) must be where they should be at
+ * any given time, whatever the strip length and however many frames get
+ * dropped.
+ *
+ * Each pattern runs once on the full strip with nothing else going on, as
+ * the reference, then on shorter strips and with every interrupt taking
+ * TEST_LOAD_MS extra (a late wake up every frame, so frames are dropped and
+ * the frame rate is a fraction of the reference's.  Two of those chained,
+ * a wake up and the overflow ISR, must stay under the 32.768ms overflow
+ * period or the timebase itself loses time, see scheduler.c.)  Every frame
+ * of those runs must show pixel 0 as the reference did within a frame
+ * period of the same time, and the pattern must take as long as the
+ * reference did.
+ *
+ * colorWipe() is timed the same way but there is no reference to go by,
+ * pixel 0 is lit from the first frame.  At wipe times down to less than a
+ * frame, with and without the load, every frame must show as many pixels
+ * lit (from pixel 0) as the time since the start says, to a pixel, the
+ * last one all of them, and the wipe must end within a frame or two of
+ * its time.  test_animation_long is all of this again on the longest
+ * strip that fits in RAM, where a wipe time shares out to well under a
+ * frame per pixel.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <msp430f2272.h>
+#include "main.h"
+#include "patterns.h"
+#include "animation.h"
+#include "scheduler.h"
+#include "WS2812B_Strip.h"
+
+#define TEST_FRAMES   1024
+#define TEST_LOAD_MS  10
+
+extern struct WS2812B_Strip strip;
+
+struct TestRun {
+  uint16_t frames;
+  uint64_t time[TEST_FRAMES];   // Since the pattern was called.
+  uint32_t pixel0[TEST_FRAMES];
+  uint16_t lit[TEST_FRAMES];    // Pixels lit, from pixel 0.
+  uint64_t length;              // Time the pattern took.
+};
+
+static struct TestRun testReferenceRun, testRun;
+static struct TestRun *testRecording;
+static uint64_t testStart;
+static int testFailures;
+
+
+static void testOnFrame(const struct HostFrame *frame)
+{
+  struct TestRun *run = testRecording;
+  uint16_t lit;
+
+  if ((run->frames == TEST_FRAMES) || (frame->bytes < 3))
+    return;
+  for (lit = 0; (lit < frame->bytes / 3) && (frame->data[3 * lit] | frame->data[3 * lit + 1] | frame->data[3 * lit + 2]); lit++)
+    ;
+  run->time[run->frames] = frame->start - testStart;
+  run->lit[run->frames] = lit;
+  run->pixel0[run->frames++] = ((uint32_t)frame->data[0] << 16) | ((uint32_t)frame->data[1] << 8) | frame->data[2];
+}
+
+
+static void testRecord(struct TestRun *run, void (*pattern)(void), uint16_t pixels, uint32_t loadMs)
+{
+  hostReset();
+  hostTimeLimit = 0;
+  hostOnFrame = testOnFrame;
+  create(&strip, pixels);
+  timebaseInit();
+  __bis_SR_register(GIE);
+  hostRunUntil(HOST_CYCLES_PER_MS);
+  hostInterruptLatency = loadMs * HOST_CYCLES_PER_MS;
+
+  testRecording = run;
+  run->frames = 0;
+  testStart = hostCycles;
+  pattern();
+  run->length = hostCycles - testStart;
+  hostFlush();
+}
+
+
+// Was the reference showing 'pixel0' within 'window' of 'time'?  Each of
+// its frames is on the LEDs until the next one (the pauses.)
+static bool testReferenceHas(uint64_t time, uint32_t pixel0, uint64_t window)
+{
+  uint64_t shown, until;
+  uint16_t i;
+
+  for (i = 0; i < testReferenceRun.frames; i++)
+  {
+    shown = testReferenceRun.time[i];
+    until = (i + 1 < testReferenceRun.frames) ? testReferenceRun.time[i + 1] : testReferenceRun.length;
+    if ((until + window >= time) && (time + window >= shown) && (testReferenceRun.pixel0[i] == pixel0))
+      return true;
+  }
+  return false;
+}
+
+
+static void testPattern(const char *name, void (*pattern)(void), uint32_t periodUs)
+{
+  static const uint16_t lengths[] = { NUMBER_OF_PIXELS, 16, 5 };
+  static const uint8_t loads[] = { 0, TEST_LOAD_MS };
+  uint64_t window = (uint64_t)periodUs * HOST_CYCLES_PER_US;
+  uint16_t i, wrong;
+  uint8_t l, load;
+  int64_t longer;
+  bool ok;
+
+  testRecord(&testReferenceRun, pattern, NUMBER_OF_PIXELS, 0);
+
+  for (l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+  {
+    for (load = 0; load < sizeof(loads) / sizeof(loads[0]); load++)
+    {
+      if ((l == 0) && (load == 0))
+        continue;
+      testRecord(&testRun, pattern, lengths[l], loads[load]);
+
+      wrong = 0;
+      for (i = 0; i < testRun.frames; i++)
+      {
+        if (testReferenceHas(testRun.time[i], testRun.pixel0[i], window) == false)
+          wrong++;
+      }
+      longer = (int64_t)(testRun.length - testReferenceRun.length);
+      // The end is seen at a late wake up, which can have the overflow ISR
+      // chained behind it: two loads.
+      ok = (wrong == 0) && (testRun.frames > 1)
+           && (llabs(longer) < (int64_t)(window + 2 * loads[load] * HOST_CYCLES_PER_MS));
+      if (ok == false)
+        testFailures++;
+      printf("%s test_animation: %s, %2u pixels, %2ums load: %3u frames (%u), %u out of phase, %+.1fms long\n",
+             ok ? "ok  " : "FAIL", name, lengths[l], loads[load], testRun.frames, testReferenceRun.frames,
+             wrong, (double)longer / HOST_CYCLES_PER_MS);
+    }
+  }
+}
+
+
+static uint32_t testWipeMs;
+
+static void testRainbow(void) { rainbow(&strip, 5); }
+static void testBreathe(void) { breathe(&strip, BLUE, 2000); }
+static void testColorWipe(void) { colorWipe(&strip, BLUE, testWipeMs); }
+
+
+static void testWipe(uint32_t wipeMs)
+{
+  static const uint8_t loads[] = { 0, TEST_LOAD_MS };
+  uint64_t wipe = (uint64_t)wipeMs * HOST_CYCLES_PER_MS, frame = (uint64_t)ANIMATION_FRAME_MS * HOST_CYCLES_PER_MS;
+  uint64_t wanted;
+  uint16_t i, wrong;
+  uint8_t load;
+  bool ok;
+
+  testWipeMs = wipeMs;
+  for (load = 0; load < sizeof(loads) / sizeof(loads[0]); load++)
+  {
+    testRecord(&testRun, testColorWipe, NUMBER_OF_PIXELS, loads[load]);
+
+    // How far the wipe should be when each frame went out, to a pixel.
+    wrong = 0;
+    for (i = 0; i < testRun.frames; i++)
+    {
+      wanted = (testRun.time[i] >= wipe) ? NUMBER_OF_PIXELS : testRun.time[i] * NUMBER_OF_PIXELS / wipe;
+      if ((testRun.lit[i] + 1 < wanted) || (testRun.lit[i] > wanted + 1))
+        wrong++;
+    }
+    // It ends at the frame after the one that finished it, which can be a
+    // frame late plus a late wake up and the overflow ISR behind it.
+    ok = (wrong == 0) && (testRun.frames > 0) && (testRun.lit[testRun.frames - 1] == NUMBER_OF_PIXELS)
+         && (testRun.length >= wipe) && (testRun.length < wipe + 2 * frame + 2 * loads[load] * HOST_CYCLES_PER_MS);
+    if (ok == false)
+      testFailures++;
+    printf("%s test_animation: colorWipe(%u), %3u pixels, %2ums load: %3u frames, %u off the wipe, took %.1fms\n",
+           ok ? "ok  " : "FAIL", wipeMs, NUMBER_OF_PIXELS, loads[load], testRun.frames, wrong,
+           (double)testRun.length / HOST_CYCLES_PER_MS);
+  }
+}
+
+
+int main(void)
+{
+  testPattern("rainbow(5)", testRainbow, 5000);
+  testPattern("breathe(2000)", testBreathe, 2000000 / 2 / BREATHE_STEPS);
+  testWipe(1000);
+  testWipe(50);
+  testWipe(5);
+
+  return (testFailures == 0) ? 0 : 1;
+}
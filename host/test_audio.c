@@ -0,0 +1,294 @@
+/*
+ * test_audio.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * The DSP path of audio.c on WAV files: every AUDIO_BLOCK_SIZE samples go
+ * through audioAnalyze() as the DTC would hand them over, 10-bit and
+ * biased to mid scale like the microphone on A0.
+ *
+ *   test_audio              write the test tones to build/, read them back
+ *                           and check the bands
+ *   test_audio file.wav     print audioLevel[] for every block of a file
+ *
+ * Files are 16-bit PCM, the first channel is used.  Any other sample rate
+ * than AUDIO_SAMPLE_RATE is taken down to it by dropping samples, so keep
+ * the interesting parts under 2kHz.
+ *
+ * The tones sit on the Goertzel bins.  Each must light its own band and
+ * leave the others at least TEST_SEPARATION below, a quarter of the
+ * amplitude must read 64 lower (log2 compression, 2 bits of power per
+ * halving, doubled), silence must read 0 and a peak must fall 8 a block.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "audio.h"
+
+#define TEST_RATE_MAX     48000
+#define TEST_SECONDS      1
+#define TEST_AMPLITUDE    16000   // Of 32767, ~250 ADC counts of 511.
+#define TEST_SEPARATION   64
+
+struct TestLevels {
+  uint16_t blocks;
+  uint8_t last[NUMBER_OF_AUDIO_BANDS];    // audioLevel[] after the last block.
+};
+
+static int testFailures;
+
+//******************************************************************************
+//  WAV files.
+//******************************************************************************
+
+static void testWrite16(FILE *file, uint16_t value)
+{
+  fputc(value & 0xFF, file);
+  fputc(value >> 8, file);
+}
+
+
+static void testWrite32(FILE *file, uint32_t value)
+{
+  testWrite16(file, (uint16_t)value);
+  testWrite16(file, (uint16_t)(value >> 16));
+}
+
+
+// A mono 16-bit WAV of the sum of 'count' sines for TEST_SECONDS, then
+// 'silenceSeconds' of silence.
+static void testWriteWav(const char *name, const uint16_t *hz, const int16_t *amplitude, uint8_t count,
+                         uint32_t rate, uint8_t silenceSeconds)
+{
+  FILE *file = fopen(name, "wb");
+  uint32_t n, samples = rate * TEST_SECONDS, total = rate * (TEST_SECONDS + silenceSeconds);
+  double sum;
+  uint8_t t;
+
+  if (file == NULL)
+  {
+    perror(name);
+    exit(1);
+  }
+  fwrite("RIFF", 1, 4, file);
+  testWrite32(file, 36 + 2 * total);
+  fwrite("WAVEfmt ", 1, 8, file);
+  testWrite32(file, 16);
+  testWrite16(file, 1);         // PCM
+  testWrite16(file, 1);         // Mono
+  testWrite32(file, rate);
+  testWrite32(file, 2 * rate);
+  testWrite16(file, 2);
+  testWrite16(file, 16);
+  fwrite("data", 1, 4, file);
+  testWrite32(file, 2 * total);
+
+  for (n = 0; n < total; n++)
+  {
+    sum = 0;
+    for (t = 0; (t < count) && (n < samples); t++)
+      sum += amplitude[t] * sin(2 * M_PI * hz[t] * n / rate);
+    testWrite16(file, (uint16_t)(int16_t)lrint(sum));
+  }
+  fclose(file);
+}
+
+
+static uint32_t testRead32(const uint8_t *p) { return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+
+// Feed a WAV file through audioAnalyze(), a block at a time.  audioLevel[]
+// after each block goes to 'each' if given.  False if it isn't a WAV we read.
+static bool testFeedWav(const char *name, struct TestLevels *levels,
+                        void (*each)(uint16_t block))
+{
+  FILE *file = fopen(name, "rb");
+  uint8_t header[12], chunk[8], format[16], frame[2 * 8];
+  uint16_t block[AUDIO_BLOCK_SIZE], channels = 0, bits = 0, n = 0;
+  uint32_t rate = 0, size, step = 0;
+
+  if (file == NULL)
+  {
+    perror(name);
+    return false;
+  }
+  memset(audioLevel, 0, sizeof(audioLevel));
+  memset(levels, 0, sizeof(*levels));
+
+  if ((fread(header, 1, 12, file) != 12) || memcmp(header, "RIFF", 4) || memcmp(&header[8], "WAVE", 4))
+    goto notWav;
+
+  //  Chunks up to "data", picking up "fmt " on the way.
+  while (fread(chunk, 1, 8, file) == 8)
+  {
+    size = testRead32(&chunk[4]);
+    if (memcmp(chunk, "fmt ", 4) == 0)
+    {
+      if ((size < 16) || (fread(format, 1, 16, file) != 16))
+        goto notWav;
+      fseek(file, size - 16 + (size & 1), SEEK_CUR);
+      channels = format[2] | (format[3] << 8);
+      rate = testRead32(&format[4]);
+      bits = format[14] | (format[15] << 8);
+      continue;
+    }
+    if (memcmp(chunk, "data", 4) != 0)
+    {
+      fseek(file, size + (size & 1), SEEK_CUR);
+      continue;
+    }
+
+    if ((format[0] != 1) || (bits != 16) || (channels == 0) || (channels > 8)
+        || (rate < AUDIO_SAMPLE_RATE) || (rate > TEST_RATE_MAX))
+      goto notWav;
+
+    //  Every frame, keeping one in rate / AUDIO_SAMPLE_RATE.
+    for (; size >= 2 * channels; size -= 2 * channels)
+    {
+      if (fread(frame, 2, channels, file) != channels)
+        break;
+      step += AUDIO_SAMPLE_RATE;
+      if (step < rate)
+        continue;
+      step -= rate;
+
+      //  16-bit signed to the ADC10's 10-bit, mid scale bias.
+      block[n++] = (uint16_t)((int16_t)(frame[0] | (frame[1] << 8)) + 32768) >> 6;
+      if (n == AUDIO_BLOCK_SIZE)
+      {
+        audioAnalyze(block);
+        memcpy(levels->last, audioLevel, sizeof(audioLevel));
+        if (each)
+          each(levels->blocks);
+        levels->blocks++;
+        n = 0;
+      }
+    }
+    fclose(file);
+    return true;
+  }
+
+notWav:
+  fprintf(stderr, "%s: not a 16-bit PCM WAV at %u - %uHz\n", name, AUDIO_SAMPLE_RATE, TEST_RATE_MAX);
+  fclose(file);
+  return false;
+}
+
+//******************************************************************************
+//  The tests.
+//******************************************************************************
+
+static const char *testBandNames[NUMBER_OF_AUDIO_BANDS] = { "bass", "mid", "treble" };
+static const uint16_t testBandHz[NUMBER_OF_AUDIO_BANDS] = { 125, 500, 1500 };
+
+// Blocks of the silence after a tone that didn't fall 8 from the one before.
+static uint8_t testPrevious[NUMBER_OF_AUDIO_BANDS];
+static uint16_t testNotFalling;
+
+
+static void testOnBlock(uint16_t block)
+{
+  uint8_t band, want;
+
+  for (band = 0; band < NUMBER_OF_AUDIO_BANDS; band++)
+  {
+    want = (testPrevious[band] > 8) ? testPrevious[band] - 8 : 0;
+    if ((block >= TEST_SECONDS * AUDIO_SAMPLE_RATE / AUDIO_BLOCK_SIZE) && (audioLevel[band] != want))
+      testNotFalling++;
+    testPrevious[band] = audioLevel[band];
+  }
+}
+
+
+static void testPrintBlock(uint16_t block)
+{
+  printf("%7.3f %3u %3u %3u\n", (double)block * AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE,
+         audioLevel[AUDIO_BAND_BASS], audioLevel[AUDIO_BAND_MID], audioLevel[AUDIO_BAND_TREBLE]);
+}
+
+
+static void testCheck(bool ok, const char *name, const struct TestLevels *levels, const char *what)
+{
+  if (ok == false)
+    testFailures++;
+  printf("%s test_audio: %-34s bass %3u mid %3u treble %3u, %s\n", ok ? "ok  " : "FAIL", name,
+         levels->last[AUDIO_BAND_BASS], levels->last[AUDIO_BAND_MID], levels->last[AUDIO_BAND_TREBLE], what);
+}
+
+
+static void testTones(void)
+{
+  static const uint32_t rates[] = { AUDIO_SAMPLE_RATE, 44100 };
+  struct TestLevels levels, quiet;
+  char name[64];
+  uint16_t hz[2];
+  int16_t amplitude[2];
+  uint8_t band, other, r;
+  bool ok;
+
+  for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+  {
+    for (band = 0; band < NUMBER_OF_AUDIO_BANDS; band++)
+    {
+      //  The tone lights its own band and only its own.
+      sprintf(name, "build/test_audio_%s_%u.wav", testBandNames[band], rates[r]);
+      hz[0] = testBandHz[band];
+      amplitude[0] = TEST_AMPLITUDE;
+      testWriteWav(name, hz, amplitude, 1, rates[r], 0);
+      testFeedWav(name, &levels, 0);
+      ok = (levels.last[band] >= TEST_SEPARATION);
+      for (other = 0; other < NUMBER_OF_AUDIO_BANDS; other++)
+      {
+        if ((other != band) && (levels.last[other] + TEST_SEPARATION > levels.last[band]))
+          ok = false;
+      }
+      testCheck(ok, name + 6, &levels, "its own band");
+
+      //  A quarter of the amplitude, 64 lower.
+      sprintf(name, "build/test_audio_%s_quiet_%u.wav", testBandNames[band], rates[r]);
+      amplitude[0] = TEST_AMPLITUDE / 4;
+      testWriteWav(name, hz, amplitude, 1, rates[r], 0);
+      testFeedWav(name, &quiet, 0);
+      testCheck(abs(levels.last[band] - quiet.last[band] - 64) <= 8, name + 6, &quiet, "64 lower at a quarter");
+    }
+  }
+
+  //  Bass and treble together, mid stays dark.
+  strcpy(name, "build/test_audio_bass_treble.wav");
+  hz[0] = testBandHz[AUDIO_BAND_BASS];
+  hz[1] = testBandHz[AUDIO_BAND_TREBLE];
+  amplitude[0] = amplitude[1] = TEST_AMPLITUDE / 2;
+  testWriteWav(name, hz, amplitude, 2, AUDIO_SAMPLE_RATE, 0);
+  testFeedWav(name, &levels, 0);
+  testCheck((levels.last[AUDIO_BAND_BASS] >= levels.last[AUDIO_BAND_MID] + TEST_SEPARATION)
+            && (levels.last[AUDIO_BAND_TREBLE] >= levels.last[AUDIO_BAND_MID] + TEST_SEPARATION),
+            name + 6, &levels, "both, not the mid");
+
+  //  A peak falls 8 a block once the tone stops, down to 0 in silence.
+  strcpy(name, "build/test_audio_bass_then_silence.wav");
+  hz[0] = testBandHz[AUDIO_BAND_BASS];
+  amplitude[0] = TEST_AMPLITUDE;
+  testWriteWav(name, hz, amplitude, 1, AUDIO_SAMPLE_RATE, 1);
+  memset(testPrevious, 0, sizeof(testPrevious));
+  testNotFalling = 0;
+  testFeedWav(name, &levels, testOnBlock);
+  testCheck((testNotFalling == 0) && (levels.last[AUDIO_BAND_BASS] == 0) && (levels.last[AUDIO_BAND_MID] == 0)
+            && (levels.last[AUDIO_BAND_TREBLE] == 0), name + 6, &levels, "falls 8 a block to silent");
+}
+
+int main(int argc, char *argv[])
+{
+  struct TestLevels levels;
+
+  if (argc > 1)
+  {
+    printf("# %s: time (s) then audioLevel[] bass, mid, treble for each block\n", argv[1]);
+    return testFeedWav(argv[1], &levels, testPrintBlock) ? 0 : 1;
+  }
+
+  testTones();
+  return (testFailures == 0) ? 0 : 1;
+}
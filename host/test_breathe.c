@@ -0,0 +1,151 @@
+/*
+ * test_breathe.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * breathe() is lossless: every frame is scaled from the color itself, so
+ * nothing is lost to rounding from one frame to the next.  For a few
+ * colors, at full brightness and at main()'s 64, two breaths in a row:
+ *
+ *  - the top of each breath is exactly what fillStripWithSolidColor() of
+ *    the color shows, and nothing is brighter,
+ *  - the final frame is the starting frame (off, breatheCurve[0] is 0),
+ *  - the second breath shows exactly the frames of the first,
+ *  - strip->brightness is what it was.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <msp430f2272.h>
+#include "main.h"
+#include "patterns.h"
+#include "scheduler.h"
+#include "WS2812B_Strip.h"
+
+#define TEST_FRAMES  512
+
+extern struct WS2812B_Strip strip;
+
+struct TestBreath {
+  uint16_t frames;
+  uint16_t top;                 // Brightest frame.
+  struct HostFrame frame[TEST_FRAMES];
+};
+
+static struct TestBreath testBreaths[2], *testRecording;
+static struct HostFrame testReference;
+static int testFailures;
+
+
+static void testOnFrame(const struct HostFrame *frame)
+{
+  if (testRecording->frames < TEST_FRAMES)
+    testRecording->frame[testRecording->frames++] = *frame;
+}
+
+
+static uint32_t testSum(const struct HostFrame *frame)
+{
+  uint32_t sum = 0;
+  uint16_t i;
+
+  for (i = 0; i < frame->bytes; i++)
+    sum += frame->data[i];
+  return sum;
+}
+
+
+static bool testSame(const struct HostFrame *a, const struct HostFrame *b)
+{
+  return (a->bytes == b->bytes) && (a->bits == b->bits) && (memcmp(a->data, b->data, a->bytes) == 0);
+}
+
+
+static void testBreathe(uint32_t c, uint8_t brightness)
+{
+  struct TestBreath *breath;
+  uint16_t i;
+  uint8_t b, before;
+  bool ok;
+
+  hostReset();
+  hostTimeLimit = 0;
+  hostOnFrame = testOnFrame;
+  create(&strip, NUMBER_OF_PIXELS);
+  setBrightness(&strip, brightness);
+  before = strip.brightness;
+  timebaseInit();
+  __bis_SR_register(GIE);
+
+  // What the color looks like without breathe().
+  testRecording = &testBreaths[0];
+  testRecording->frames = 0;
+  fillStripWithSolidColor(&strip, c);
+  hostFlush();
+  testReference = testRecording->frame[0];
+
+  for (b = 0; b < 2; b++)
+  {
+    breath = testRecording = &testBreaths[b];
+    breath->frames = 0;
+    breathe(&strip, c, 2000);
+    hostFlush();
+
+    breath->top = 0;
+    for (i = 1; i < breath->frames; i++)
+    {
+      if (testSum(&breath->frame[i]) > testSum(&breath->frame[breath->top]))
+        breath->top = i;
+    }
+  }
+
+  breath = &testBreaths[0];
+  ok = (breath->frames > 2) && testSame(&breath->frame[breath->top], &testReference);
+  if (ok == false)
+    printf("     test_breathe: top of the breath isn't the color\n");
+  if (testSame(&breath->frame[breath->frames - 1], &breath->frame[0]) == false)
+  {
+    ok = false;
+    printf("     test_breathe: final frame isn't the starting frame\n");
+  }
+  if ((testBreaths[1].frames != breath->frames) || (testBreaths[1].top != breath->top))
+  {
+    ok = false;
+    printf("     test_breathe: second breath has %u frames, top at %u, not %u at %u\n",
+           testBreaths[1].frames, testBreaths[1].top, breath->frames, breath->top);
+  }
+  for (i = 0; ok && (i < breath->frames); i++)
+  {
+    if (testSame(&testBreaths[1].frame[i], &breath->frame[i]) == false)
+    {
+      ok = false;
+      printf("     test_breathe: second breath differs at frame %u\n", i);
+    }
+  }
+  if (strip.brightness != before)
+  {
+    ok = false;
+    printf("     test_breathe: brightness left at %u\n", strip.brightness);
+  }
+
+  if (ok == false)
+    testFailures++;
+  printf("%s test_breathe: %06X at brightness %3u: %u frames, top %u is the color, ends where it started\n",
+         ok ? "ok  " : "FAIL", c, brightness, breath->frames, breath->top);
+}
+
+
+int main(void)
+{
+  static const uint32_t colors[] = { BLUE, 0x123456, 0xFF8001 };
+  uint8_t i;
+
+  for (i = 0; i < sizeof(colors) / sizeof(colors[0]); i++)
+  {
+    testBreathe(colors[i], 255);
+    testBreathe(colors[i], 64);
+  }
+
+  return (testFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,229 @@
+/*
+ * test_dco.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * dco.c against a modelled DCO and watch crystal (built with DCO_CRYSTAL
+ * 1, see the Makefile).  The model is the F2xx datasheet's shape: each
+ * RSEL ~1.35x the last, each DCO tap ~1.08x, MOD interpolating between
+ * taps, all times a temperature drift.  Each TACCTL2 poll is one
+ * "instruction"; an ACLK/8 edge lands every TEST_EDGE_POLLS of them and
+ * Timer_A's capture is the SMCLK counted by then.
+ *
+ *  1. Boot trim from a spread of starting points and drifts must lock
+ *     within DCO_TOLERANCE (plus a count of quantisation.)
+ *  2. dcoService() must follow a slow +/-3% drift.
+ *  3. A first edge that takes most of the timeout must not time out the
+ *     second capture.  ACLK stopping after the first must unlock.
+ *  4. A DCO that can't reach 16MHz: the trim walks the whole RSEL range up
+ *     (and from RSEL 3 down), every measurement at least as fast (slow) as the
+ *     one before, carrying from RSEL to RSEL, and stays at the end of the
+ *     range instead of wrapping DCOCTL round.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <msp430f2272.h>
+#include "dco.h"
+#include "scheduler.h"
+
+#define TEST_EDGE_POLLS  600     // ACLK/8 period in polls of TACCTL2.
+#define TEST_ERROR_MAX   0.005   // Of 16MHz, DCO_TOLERANCE and a count.
+
+static double testDrift = 1.0;
+static double testCounted;       // SMCLK counted by Timer_A so far.
+static uint32_t testPolls, testFirstPolls = TEST_EDGE_POLLS;
+static int testCapturesLeft = -1;  // Then ACLK stops.  -1 = never.
+static uint8_t testCaptures;
+static int testFailures;
+
+// Measurements against the last, for 4.
+static double testLastFrequency;
+static int testDirection;        // +1 up, -1 down, 0 not checking.
+static uint16_t testWrongWay;
+
+
+static double testFrequency(void)
+{
+  uint8_t rsel = BCSCTL1 & (RSEL3 | RSEL2 | RSEL1 | RSEL0);
+  uint8_t dco = DCOCTL >> 5, mod = DCOCTL & 0x1F;
+
+  return 1.355e5 * pow(1.35, rsel) * pow(1.08, dco + ((dco == 7) ? 0 : mod / 32.0)) * testDrift;
+}
+
+
+static double testError(void)
+{
+  return testFrequency() / 16e6 - 1;
+}
+
+
+// Every TACCTL2 access.  TACCTL2 = ... in dcoMeasure() starts a new
+// measurement.
+static void testCapture(volatile uint16_t *tacctl2)
+{
+  if ((*tacctl2 & CAP) == 0)
+  {
+    if ((testDirection != 0) && ((testFrequency() - testLastFrequency) * testDirection < 0))
+      testWrongWay++;
+    testLastFrequency = testFrequency();
+    testCaptures = 0;
+    testPolls = 0;
+    return;
+  }
+  if ((*tacctl2 & CCIFG) || (testCapturesLeft == 0))
+    return;
+  if (++testPolls < ((testCaptures == 0) ? testFirstPolls : TEST_EDGE_POLLS))
+    return;
+
+  testPolls = 0;
+  testCaptures++;
+  if (testCapturesLeft > 0)
+    testCapturesLeft--;
+  testCounted += testFrequency() / 4096.0;
+  TACCR2 = (uint16_t)(uint32_t)testCounted;
+  *tacctl2 |= CCIFG;
+}
+
+
+static void testCheck(bool ok, const char *format, double value)
+{
+  if (ok == false)
+    testFailures++;
+  printf("%s test_dco: ", ok ? "ok  " : "FAIL");
+  printf(format, value);
+  printf("\n");
+}
+
+
+// 1. Boot trim from every starting point within ~25% of 16MHz.
+static void testBoot(void)
+{
+  uint8_t rsel, dco, mod;
+  double drift, worst = 0;
+  int runs = 0, fails = 0;
+
+  for (drift = 0.90; drift < 1.101; drift += 0.02)
+  {
+    for (rsel = 13; rsel <= 15; rsel++)
+    {
+      for (dco = 0; dco < 8; dco++)
+      {
+        for (mod = 0; mod < 32; mod += 7)
+        {
+          testDrift = 1.0;
+          BCSCTL1 = XT2OFF | rsel;
+          DCOCTL = (dco << 5) | mod;
+          if (fabs(testError()) > 0.25)
+            continue;
+
+          testDrift = drift;
+          runs++;
+          if ((dcoCalibrate() == false) || (fabs(testError()) > TEST_ERROR_MAX))
+            fails++;
+          else if (fabs(testError()) > worst)
+            worst = fabs(testError());
+        }
+      }
+    }
+  }
+  testCheck(fails == 0, "%.0f boot trims failed to lock", fails);
+  testCheck(worst <= TEST_ERROR_MAX, "boot trim worst error %.2f%%", 100 * worst);
+  printf("     test_dco: (%d boot trims, drift 0.90 - 1.10)\n", runs);
+}
+
+
+// 2. An hour of a +/-3% drift, one dcoService() every 10s.
+static void testTracking(void)
+{
+  uint16_t i;
+  double worst = 0;
+  bool locked = true;
+
+  testDrift = 1.0;
+  BCSCTL1 = CALBC1_16MHZ;
+  DCOCTL = CALDCO_16MHZ;
+  dcoCalibrate();
+
+  timebaseInit();
+  __bis_SR_register(GIE);
+  for (i = 0; i < 360; i++)
+  {
+    testDrift = 1.0 + 0.03 * sin(i / 60.0);
+    hostRunUntil(hostCycles + 10000ULL * HOST_CYCLES_PER_MS);
+    dcoService(timebaseNow() + 10 * TIMEBASE_TICKS_PER_MS);
+    locked &= dcoStatus.locked;
+    if (fabs(testError()) > worst)
+      worst = fabs(testError());
+  }
+  testCheck(locked, "lock lost %.0f times while tracking", !locked);
+  testCheck(worst <= TEST_ERROR_MAX + 0.003, "tracking +/-3%% drift, worst error %.2f%%", 100 * worst);
+}
+
+
+// 3. Slow first edge, then ACLK stopping.
+static void testTimeouts(void)
+{
+  hostRunUntil(hostCycles + 10000ULL * HOST_CYCLES_PER_MS);
+  testFirstPolls = 0xFFFF - 100;
+  dcoService(timebaseNow() + 10 * TIMEBASE_TICKS_PER_MS);
+  testCheck(dcoStatus.locked && (dcoStatus.error >= -DCO_TOLERANCE) && (dcoStatus.error <= DCO_TOLERANCE),
+            "slow first edge, measured error %.0f counts", dcoStatus.error);
+
+  hostRunUntil(hostCycles + 10000ULL * HOST_CYCLES_PER_MS);
+  testFirstPolls = TEST_EDGE_POLLS;
+  testCapturesLeft = 1;
+  dcoService(timebaseNow() + 10 * TIMEBASE_TICKS_PER_MS);
+  testCheck(dcoStatus.locked == false, "ACLK stopped after one capture, locked %.0f", dcoStatus.locked);
+}
+
+
+// 4. Walk the whole range, with the drift putting 16MHz out of reach.
+static bool testWalk(int direction, double drift, uint8_t rsel, uint8_t dcoctl)
+{
+  uint8_t calls;
+
+  testDrift = drift;
+  testDirection = direction;
+  testLastFrequency = testFrequency();
+  testWrongWay = 0;
+  for (calls = 0; calls < 8; calls++)
+    dcoCalibrate();
+  testDirection = 0;
+
+  return (testWrongWay == 0) && ((BCSCTL1 & (RSEL3 | RSEL2 | RSEL1 | RSEL0)) == rsel) && (DCOCTL == dcoctl);
+}
+
+
+static void testRangeEnds(void)
+{
+  testFirstPolls = TEST_EDGE_POLLS;
+  testCapturesLeft = -1;
+
+  BCSCTL1 = XT2OFF | 0;
+  DCOCTL = 0x00;
+  testCheck(testWalk(1, 0.5, 15, 0xE0), "RSEL 0 up to RSEL 15 tap 7, %.0f steps the wrong way", testWrongWay);
+  testCheck(testWalk(1, 0.5, 15, 0xE0), "held at RSEL 15 tap 7, %.0f steps the wrong way", testWrongWay);
+
+  // Down from RSEL 3, Timer_A's 16 bits can't count a fast enough RSEL 15.
+  BCSCTL1 = XT2OFF | 3;
+  DCOCTL = 0xE0;
+  testCheck(testWalk(-1, 150.0, 0, 0x00), "RSEL 3 down to RSEL 0 tap 0, %.0f steps the wrong way", testWrongWay);
+  testCheck(testWalk(-1, 150.0, 0, 0x00), "held at RSEL 0 tap 0, %.0f steps the wrong way", testWrongWay);
+}
+
+
+int main(void)
+{
+  hostReset();
+  hostTimeLimit = 0;
+  hostTimerACapture = testCapture;
+
+  testBoot();
+  testTracking();
+  testTimeouts();
+  testRangeEnds();
+
+  return (testFailures == 0) ? 0 : 1;
+}
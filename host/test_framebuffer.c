@@ -0,0 +1,133 @@
+/*
+ * test_framebuffer.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * The front/back buffers (FRAMEBUFFER_MODE) against the button ISR landing
+ * halfway through a frame.  Built once for DOUBLE and once for HALF (see
+ * the Makefile.)
+ *
+ * For every pixel k of the strip: draw and show frame A, draw the first k
+ * pixels of frame B, press the button (Port_1 blank()s the strip), draw
+ * the rest of B and show it.  The wire must carry exactly A, a blank frame
+ * and B: no half drawn B, and nothing of B lost to the blank.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <msp430f2272.h>
+#include "main.h"
+#include "patterns.h"
+#include "WS2812B_Strip.h"
+
+#define TEST_FRAMES  4
+
+extern struct WS2812B_Strip strip;
+
+static struct HostFrame testFrames[TEST_FRAMES];
+static uint8_t testFrameCount;
+static struct HostFrame testA, testB, testBlank;
+
+
+static void testOnFrame(const struct HostFrame *frame)
+{
+  if (testFrameCount < TEST_FRAMES)
+    testFrames[testFrameCount] = *frame;
+  testFrameCount++;
+}
+
+
+static bool testSame(const struct HostFrame *frame, const struct HostFrame *want)
+{
+  return (frame->bytes == want->bytes) && (frame->bits == 0)
+         && (memcmp(frame->data, want->data, frame->bytes) == 0);
+}
+
+
+static uint32_t testColorA(uint16_t i) { return color(i * 6, 0x40, 255 - i * 6); }
+static uint32_t testColorB(uint16_t i) { return color(0x10, i * 5, 0x80); }
+
+
+static void testDraw(uint32_t (*colorOf)(uint16_t), uint16_t first, uint16_t last)
+{
+  uint16_t i;
+
+  for (i = first; i < last; i++)
+    setPixelColor(&strip, i, colorOf(i));
+}
+
+
+// The wire as it should look, from a frame drawn and shown undisturbed.
+static void testReference(struct HostFrame *frame, uint32_t (*colorOf)(uint16_t))
+{
+  testFrameCount = 0;
+  if (colorOf)
+    testDraw(colorOf, 0, strip.numberOfPixels);
+  else
+    clear(&strip);
+  show(&strip);
+  hostFlush();
+  *frame = testFrames[0];
+}
+
+
+static void testRelease(uint32_t unused)
+{
+  P1IN |= PSC_SW_PIN;
+}
+
+
+// A 1.5s press: blank, then the brightness change, which is put back.
+static void testPress(void)
+{
+  P1IN &= ~PSC_SW_PIN;
+  hostSchedule(hostCycles + 1500 * HOST_CYCLES_PER_MS, testRelease, 0);
+  hostRaise(PORT1_VECTOR);
+  strip.breakFromPattern = false;
+  strip.brightness = 0;
+}
+
+
+int main(void)
+{
+  uint16_t k, failures = 0;
+  bool ok;
+
+  hostReset();
+  hostTimeLimit = 0;
+  hostOnFrame = testOnFrame;
+  create(&strip, NUMBER_OF_PIXELS);
+  PSC_SW_PORT_IE |= PSC_SW_PIN;
+  __bis_SR_register(GIE);
+
+  testReference(&testBlank, NULL);
+  testReference(&testA, testColorA);
+  testReference(&testB, testColorB);
+
+  for (k = 0; k <= strip.numberOfPixels; k++)
+  {
+    testFrameCount = 0;
+    testDraw(testColorA, 0, strip.numberOfPixels);
+    show(&strip);
+    testDraw(testColorB, 0, k);
+    testPress();
+    testDraw(testColorB, k, strip.numberOfPixels);
+    show(&strip);
+    hostFlush();
+
+    ok = (testFrameCount == 3) && testSame(&testFrames[0], &testA)
+         && testSame(&testFrames[1], &testBlank) && testSame(&testFrames[2], &testB);
+    if (ok == false)
+    {
+      failures++;
+      printf("FAIL test_framebuffer: button after %u of %u pixels, %u frames\n",
+             k, strip.numberOfPixels, testFrameCount);
+    }
+  }
+
+  if (failures == 0)
+    printf("ok   test_framebuffer: button after 0 - %u of %u pixels, FRAMEBUFFER_MODE %d\n",
+           strip.numberOfPixels, strip.numberOfPixels, FRAMEBUFFER_MODE);
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,339 @@
+/*
+ * test_i2c.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * Pixel uploads from a 400kHz I2C host, through the real USCI_B0 ISR and
+ * hostPixels().  The bus model clocks a byte in every TEST_BYTE_CYCLES, but
+ * never before the firmware has read the one before it, which is the
+ * USCI's clock stretching.
+ *
+ *  1. TEST_UPLOADS back to back uploads of the whole strip: every one must
+ *     come out on the LEDs as sent (scaled by I2C_REG_BRIGHTNESS), and the
+ *     bus must only be stretched for show(), TEST_STRETCH_US per upload.
+ *  2. An upload that starts while patternRGB is in its delay_ms(1000): the
+ *     first pixel byte may only be held for a frame, TEST_HANDOVER_US.
+ *  3. Back to back writes of one byte each, into patternRGB: the first
+ *     pixel byte is held while the host's STOP and next START go by, and
+ *     must still land as a pixel, not the next register.  The brightness
+ *     written ahead of it reaches the strip through setBrightness().
+ *
+ * The ISR's own time is not in it (C code is free on the host), that is
+ * the ~100 cycles a byte in i2c.c against the 360 a byte takes on the bus.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <msp430f2272.h>
+#include "main.h"
+#include "patterns.h"
+#include "colormath.h"
+#include "i2c.h"
+#include "scheduler.h"
+#include "WS2812B_Strip.h"
+
+#define TEST_BYTE_CYCLES   (9 * HOST_CYCLES_PER_MS / 400)  // 8 bits and ACK.
+#define TEST_UPLOADS       16
+#define TEST_BRIGHTNESS    127
+#define TEST_STRETCH_US    1500  // show() of 38 pixels is ~1.2ms.
+#define TEST_HANDOVER_US   5000
+#define TEST_BUS_BYTES     (TEST_UPLOADS * (3 * NUMBER_OF_PIXELS + 8) + 16)
+#define TEST_FRAMES        (TEST_UPLOADS + 8)
+
+extern struct WS2812B_Strip strip;
+
+#define TEST_START  HOST_I2C_START   // First byte of a write, and last:
+#define TEST_STOP   0x200
+
+static uint16_t testBus[TEST_BUS_BYTES];  // Byte, | TEST_START, TEST_STOP.
+static uint16_t testBusLength, testBusNext;
+static uint64_t testBusLast;              // Last byte clocked in.
+static uint64_t testBusRead[TEST_BUS_BYTES];
+
+static struct HostFrame testFrames[TEST_FRAMES];
+static uint8_t testFrameCount;
+static int testFailures;
+
+
+static void testOnFrame(const struct HostFrame *frame)
+{
+  if (testFrameCount < TEST_FRAMES)
+    testFrames[testFrameCount] = *frame;
+  testFrameCount++;
+}
+
+
+static void testCheck(bool ok, const char *format, double value)
+{
+  if (ok == false)
+    testFailures++;
+  printf("%s test_i2c: ", ok ? "ok  " : "FAIL");
+  printf(format, value);
+  printf("\n");
+}
+
+//******************************************************************************
+//  The bus.
+//******************************************************************************
+
+// Append a write transaction: [register] [data...].
+static void testWrite(uint8_t reg, const uint8_t *data, uint16_t length)
+{
+  testBus[testBusLength++] = reg | TEST_START;
+  while (length--)
+    testBus[testBusLength++] = *data++;
+  testBus[testBusLength - 1] |= TEST_STOP;
+}
+
+
+static void testUpload(uint8_t frame)
+{
+  uint8_t pixels[3 * NUMBER_OF_PIXELS + 2];
+  uint8_t one = 1;
+  uint16_t i;
+
+  pixels[0] = pixels[1] = 0;  // Window.
+  for (i = 0; i < NUMBER_OF_PIXELS; i++)
+  {
+    pixels[2 + 3 * i] = frame * 13 + i;  // R
+    pixels[3 + 3 * i] = 3 * i;           // G
+    pixels[4 + 3 * i] = 255 - frame;     // B
+  }
+  testWrite(I2C_REG_WINDOW_LOW, pixels, sizeof(pixels));
+  testWrite(I2C_REG_SHOW, &one, 1);
+}
+
+
+// The last byte of a write is followed by a STOP, and the next write's
+// START, straight away: they don't wait for the byte to be read.
+static void testClockIn(uint32_t data)
+{
+  testBusLast = hostCycles;
+  hostI2cByte(data & 0xFF);
+  if (data & TEST_STOP)
+  {
+    hostSchedule(hostCycles + TEST_BYTE_CYCLES / 9, hostI2cStop, 0);
+    if (testBusNext + 1 < testBusLength)
+      hostSchedule(hostCycles + 2 * TEST_BYTE_CYCLES / 9, hostI2cStart, 0);
+  }
+}
+
+
+// The address after a START takes another byte time.
+static void testClockNext(uint64_t earliest)
+{
+  uint16_t data = testBus[testBusNext];
+
+  if (data & TEST_START)
+    earliest += TEST_BYTE_CYCLES;
+  hostSchedule(earliest, testClockIn, data);
+}
+
+
+// UCB0RXBUF read: the next byte has been shifting in since the last one
+// landed, and lands now if it already would have.
+static void testOnRead(void)
+{
+  uint64_t at = testBusLast + TEST_BYTE_CYCLES;
+
+  testBusRead[testBusNext++] = hostCycles;
+  if (testBusNext < testBusLength)
+    testClockNext((at > hostCycles) ? at : hostCycles);
+}
+
+
+static void testBusStart(uint64_t at)
+{
+  testBusNext = 0;
+  testBusLast = at;
+  hostSchedule(at + TEST_BYTE_CYCLES, hostI2cStart, 0);
+  testClockNext(at + TEST_BYTE_CYCLES);
+}
+
+//******************************************************************************
+//  The firmware: main()'s loop for the two patterns used here.
+//******************************************************************************
+
+static void testPatterns(uint64_t until)
+{
+  while (hostCycles < until)
+  {
+    strip.breakFromPattern = false;
+    if (patternState == patternHost)
+    {
+      hostPixels(&strip);
+      continue;
+    }
+    fillStripWithSolidColor(&strip, color(0xFF,    0,    0));
+    delay_ms(1000);
+    fillStripWithSolidColor(&strip, color(   0, 0xFF,    0));
+    delay_ms(1000);
+    fillStripWithSolidColor(&strip, color(   0,    0, 0xFF));
+    delay_ms(1000);
+  }
+}
+
+
+static void testReset(void)
+{
+  hostReset();
+  hostTimeLimit = 0;
+  hostOnFrame = testOnFrame;
+  hostOnI2cRead = testOnRead;
+  create(&strip, NUMBER_OF_PIXELS);
+  timebaseInit();
+  i2cInit(&strip);
+  __bis_SR_register(GIE);
+  patternState = patternRGB;
+  testBusLength = 0;
+  testFrameCount = 0;
+}
+
+//******************************************************************************
+//  The tests.
+//******************************************************************************
+
+// Is 'shown' upload 'frame', as the LEDs should get it?
+static bool testShownAs(const struct HostFrame *shown, uint8_t frame)
+{
+  uint16_t i;
+
+  if (shown->bytes != 3 * NUMBER_OF_PIXELS)
+    return false;
+  for (i = 0; i < NUMBER_OF_PIXELS; i++)
+  {
+    if ((shown->data[3 * i + 1] != scale8(frame * 13 + i, TEST_BRIGHTNESS))
+        || (shown->data[3 * i] != scale8(3 * i, TEST_BRIGHTNESS))
+        || (shown->data[3 * i + 2] != scale8(255 - frame, TEST_BRIGHTNESS)))
+      return false;
+  }
+  return true;
+}
+
+
+// 1. Back to back uploads.
+static void testThroughput(void)
+{
+  uint8_t host = patternHost, brightness = TEST_BRIGHTNESS, back = patternRGB;
+  uint16_t uploadStart, uploadEnd, bad = 0;
+  uint8_t frame, first;
+  uint64_t start, busOnly;
+  double stretch;
+
+  testReset();
+  testWrite(I2C_REG_PATTERN, &host, 1);
+  testWrite(I2C_REG_BRIGHTNESS, &brightness, 1);
+  uploadStart = testBusLength;
+  for (frame = 0; frame < TEST_UPLOADS; frame++)
+    testUpload(frame);
+  uploadEnd = testBusLength;
+  testWrite(I2C_REG_PATTERN, &back, 1);
+
+  testBusStart(HOST_CYCLES_PER_MS);
+  testPatterns(500 * HOST_CYCLES_PER_MS);
+  hostFlush();
+
+  // Every upload on the LEDs, one after the other.
+  for (first = 0; first < testFrameCount && first < TEST_FRAMES; first++)
+  {
+    if (testShownAs(&testFrames[first], 0))
+      break;
+  }
+  for (frame = 0; frame < TEST_UPLOADS; frame++)
+  {
+    if ((first + frame >= TEST_FRAMES) || (testShownAs(&testFrames[first + frame], frame) == false))
+      bad++;
+  }
+  testCheck(bad == 0, "%.0f uploads not shown as sent", bad);
+
+  // Bus time against the bytes it carried.
+  start = testBusRead[uploadStart - 1];
+  busOnly = (uint64_t)(uploadEnd - uploadStart + 2 * TEST_UPLOADS) * TEST_BYTE_CYCLES;
+  stretch = (double)(testBusRead[uploadEnd - 1] - start - busOnly) / TEST_UPLOADS / HOST_CYCLES_PER_US;
+  testCheck(stretch < TEST_STRETCH_US, "bus stretched %.0fus per upload", stretch);
+  printf("     test_i2c: %.0f pixels/s over %d uploads of %d pixels\n",
+         (double)TEST_UPLOADS * NUMBER_OF_PIXELS * HOST_CYCLES_PER_MS * 1000
+         / (testBusRead[uploadEnd - 1] - start), TEST_UPLOADS, NUMBER_OF_PIXELS);
+}
+
+
+// 2. Pixels straight into patternRGB's delay.
+static void testHandover(void)
+{
+  uint8_t brightness = TEST_BRIGHTNESS, back = patternRGB, frame;
+  uint16_t pixels;
+  uint64_t landed, held;
+  bool shown = false;
+
+  testReset();
+  testWrite(I2C_REG_BRIGHTNESS, &brightness, 1);
+  pixels = testBusLength + 3;  // After the register and the window.
+  testUpload(0);
+  testWrite(I2C_REG_PATTERN, &back, 1);
+  testBusStart(10 * HOST_CYCLES_PER_MS);
+  testPatterns(500 * HOST_CYCLES_PER_MS);
+  hostFlush();
+
+  // It landed a byte after the one before it was read.  (Still unread?)
+  landed = testBusRead[pixels - 1] + TEST_BYTE_CYCLES;
+  held = ((testBusNext > pixels) ? testBusRead[pixels] : hostCycles) - landed;
+  testCheck(held < TEST_HANDOVER_US * HOST_CYCLES_PER_US,
+            "first pixel byte held %.0fus while patternRGB handed over",
+            (double)held / HOST_CYCLES_PER_US);
+
+  for (frame = 0; (frame < testFrameCount) && (frame < TEST_FRAMES); frame++)
+    shown |= testShownAs(&testFrames[frame], 0);
+  testCheck(shown, "upload into patternRGB shown %.0f", shown);
+}
+
+
+// 3. One byte writes, the first held across the STOP and next START.
+static void testBackToBack(void)
+{
+  static const uint8_t sent[6] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+  uint8_t brightness = TEST_BRIGHTNESS, back = patternRGB, one = 1, window[2] = { 0, 0 };
+  uint8_t frame, i;
+  const struct HostFrame *shown;
+  bool ok = false;
+
+  testReset();
+  testWrite(I2C_REG_BRIGHTNESS, &brightness, 1);
+  testWrite(I2C_REG_WINDOW_LOW, window, 2);
+  for (i = 0; i < sizeof(sent); i++)
+    testWrite(I2C_REG_PIXELS, &sent[i], 1);
+  testWrite(I2C_REG_SHOW, &one, 1);
+  testWrite(I2C_REG_PATTERN, &back, 1);
+  testBusStart(10 * HOST_CYCLES_PER_MS);
+  testPatterns(500 * HOST_CYCLES_PER_MS);
+  hostFlush();
+
+  // Two pixels (R, G, B on the wire as G, R, B), the rest clear.
+  for (frame = 0; (frame < testFrameCount) && (frame < TEST_FRAMES) && (ok == false); frame++)
+  {
+    shown = &testFrames[frame];
+    ok = (shown->bytes == 3 * NUMBER_OF_PIXELS);
+    for (i = 0; ok && (i < 2); i++)
+    {
+      ok = (shown->data[3 * i + 1] == scale8(sent[3 * i], TEST_BRIGHTNESS))
+           && (shown->data[3 * i] == scale8(sent[3 * i + 1], TEST_BRIGHTNESS))
+           && (shown->data[3 * i + 2] == scale8(sent[3 * i + 2], TEST_BRIGHTNESS));
+    }
+    for (i = 6; ok && (i < shown->bytes); i++)
+      ok = (shown->data[i] == 0);
+  }
+  testCheck(ok && (testBusNext == testBusLength) && (patternState == patternRGB),
+            "%.0f one byte writes back to back, held byte landed as a pixel", sizeof(sent) + 4);
+  testCheck(strip.brightness == TEST_BRIGHTNESS + 1, "brightness %.0f through setBrightness()",
+            strip.brightness - 1);
+}
+
+
+int main(void)
+{
+  testThroughput();
+  testHandover();
+  testBackToBack();
+
+  return (testFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+/*
+ * test_ir.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * NEC remote traces against the real capture ISR and decoder, while the
+ * fast patterns keep show() turning interrupts off.
+ *
+ *  1. Key presses at varying phases against rainbowCycle() (show() every
+ *     5ms) and rainbow() (every 15ms) must all get through.
+ *  2. A held key's repeat codes must each step the brightness.
+ *  3. A first press after an idle gap that wraps the 16-bit timer to
+ *     ~9ms, fed straight to irDecode() and through the capture.
+ */
+
+#include <stdio.h>
+#include <msp430f2272.h>
+#include "main.h"
+#include "patterns.h"
+#include "ir.h"
+#include "scheduler.h"
+#include "WS2812B_Strip.h"
+
+#define TEST_PRESSES  40
+
+extern struct WS2812B_Strip strip;
+
+static const uint8_t testDigitKeys[2] = { 0x0C, 0x18 };  // 1, 2
+static int testPasses, testFailures;
+static int testPressesSeen;
+
+
+static void testCheck(bool ok, const char *what)
+{
+  if (ok)
+  {
+    testPasses++;
+    return;
+  }
+  testFailures++;
+  fprintf(stderr, "test_ir: %s\n", what);
+}
+
+
+// Schedule the edges of 'durations' (us, alternating mark and space)
+// starting with a mark at 'at'.  The receiver is active low.
+static uint64_t testEdges(uint64_t at, const uint16_t *durations, uint8_t count)
+{
+  uint8_t i;
+
+  hostSchedule(at, hostIrEdge, 0);
+  for (i = 0; i < count; i++)
+  {
+    at += (uint64_t)durations[i] * HOST_CYCLES_PER_US;
+    hostSchedule(at, hostIrEdge, i & 1 ? 0 : 1);
+  }
+  return at;
+}
+
+
+// A whole NEC frame for address 0 and 'command'.
+static uint64_t testSendFrame(uint64_t at, uint8_t command)
+{
+  uint16_t durations[2 + 64 + 1];
+  uint32_t bits = 0x0000FF00 | ((uint32_t)command << 16) | ((uint32_t)(uint8_t)~command << 24);
+  uint8_t i;
+
+  durations[0] = 9000;
+  durations[1] = 4500;
+  for (i = 0; i < 32; i++)
+  {
+    durations[2 + 2 * i] = 562;
+    durations[3 + 2 * i] = (bits & ((uint32_t)1 << i)) ? 1687 : 562;
+  }
+  durations[66] = 562;
+  return testEdges(at, durations, 67);
+}
+
+
+static uint64_t testSendRepeat(uint64_t at)
+{
+  static const uint16_t durations[3] = { 9000, 2250, 562 };
+  return testEdges(at, durations, 3);
+}
+
+
+// Nothing on the strip, just decode like delay_ms() does.
+static void testIdle(uint64_t until)
+{
+  while (hostCycles < until)
+  {
+    timebaseSleepUntil(timebaseNow() + TIMEBASE_TICKS_PER_MS);
+    irPoll(&strip);
+  }
+}
+
+
+// Each press should have picked its pattern by now.
+static void testPressDone(uint32_t digit)
+{
+  if (patternState == (enum pattern)digit)
+    testPressesSeen++;
+  patternState = patternRGB;
+}
+
+
+static void testPresses(void (*pattern)(void), const char *name)
+{
+  uint64_t at = hostCycles + 20 * HOST_CYCLES_PER_MS, end = 0;
+  uint8_t i;
+
+  testPressesSeen = 0;
+
+  // Start times step 0.37ms through the show() period, so presses land in
+  // every phase of it.
+  for (i = 0; i < TEST_PRESSES; i++)
+  {
+    at += 150 * HOST_CYCLES_PER_MS + 370 * HOST_CYCLES_PER_US;
+    end = testSendFrame(at, testDigitKeys[i & 1]);
+    hostSchedule(end + 20 * HOST_CYCLES_PER_MS, testPressDone, 1 + (i & 1));
+  }
+  while (hostCycles < end + 30 * HOST_CYCLES_PER_MS)
+  {
+    strip.breakFromPattern = false;
+    pattern();
+  }
+  testCheck(testPressesSeen == TEST_PRESSES, "key presses lost to show()");
+  printf("%s test_ir: %d of %d presses during %s\n", (testPressesSeen == TEST_PRESSES) ? "ok  " : "FAIL",
+         testPressesSeen, TEST_PRESSES, name);
+}
+
+
+static void testRainbowCycle(void) { rainbowCycle(&strip, 5); }
+static void testRainbow(void)      { rainbow(&strip, 15); }
+
+
+// Volume up, held for five repeat codes.
+static void testRepeats(void)
+{
+  uint64_t at = hostCycles + 20 * HOST_CYCLES_PER_MS, end;
+  uint8_t i;
+
+  setBrightness(&strip, 64);
+  at = testSendFrame(at, IR_KEY_VOL_UP);
+  for (i = 0; i < 5; i++)
+  {
+    at += 40 * HOST_CYCLES_PER_MS;  // 108ms frame to frame.
+    at = testSendRepeat(at);
+  }
+  end = at;
+  while (hostCycles < end + 30 * HOST_CYCLES_PER_MS)
+  {
+    strip.breakFromPattern = false;
+    rainbowCycle(&strip, 5);
+  }
+  testCheck(strip.brightness == 64 + 6 * IR_BRIGHTNESS_STEP + 1, "repeat codes lost");
+  printf("%s test_ir: brightness %d after a press and 5 repeats (want %d)\n",
+         (strip.brightness == 64 + 6 * IR_BRIGHTNESS_STEP + 1) ? "ok  " : "FAIL",
+         strip.brightness - 1, 64 + 6 * IR_BRIGHTNESS_STEP);
+}
+
+
+// First press after an idle gap whose remainder mod 32.768ms looks like a
+// leader mark.
+static void testWrappedGap(void)
+{
+  uint8_t command = 0, result = IR_KEY_NONE, i;
+  uint64_t at, end;
+
+  // Straight into the decoder: gap, leader, space, then the bits of 0x40.
+  uint32_t bits = 0x0000FF00 | ((uint32_t)IR_KEY_NEXT << 16) | ((uint32_t)(uint8_t)~IR_KEY_NEXT << 24);
+  irDecode(140, &command);  // Wrapped gap, looks like a leader.
+  irDecode(140, &command);  // The real leader.
+  irDecode(70, &command);
+  for (i = 0; i < 32; i++)
+  {
+    irDecode(9, &command);
+    result = irDecode((bits & ((uint32_t)1 << i)) ? 26 : 9, &command);
+  }
+  result = irDecode(9, &command);
+  testCheck((result == IR_KEY_PRESSED) && (command == IR_KEY_NEXT), "leader after a leader sized gap");
+  printf("%s test_ir: irDecode(140, 140, 70, ...) gives 0x%02X (want 0x%02X)\n",
+         (command == IR_KEY_NEXT) ? "ok  " : "FAIL", command, IR_KEY_NEXT);
+
+  // Through the capture: a press, then the next one's first edge two
+  // overflows and 9ms after the last edge of it.
+  end = testSendFrame(hostCycles + 20 * HOST_CYCLES_PER_MS, testDigitKeys[0]);
+  testIdle(end + 20 * HOST_CYCLES_PER_MS);
+  patternState = patternRGB;
+  at = end + 2 * 65536 * 8 + 9 * HOST_CYCLES_PER_MS;
+  end = testSendFrame(at, testDigitKeys[1]);
+  testIdle(end + 20 * HOST_CYCLES_PER_MS);
+  testCheck(patternState == patternPoliceLights, "first press after a wrapped gap");
+  printf("%s test_ir: first press after a 74.5ms idle gap\n",
+         (patternState == patternPoliceLights) ? "ok  " : "FAIL");
+}
+
+
+int main(void)
+{
+  hostReset();
+  create(&strip, NUMBER_OF_PIXELS);
+  setBrightness(&strip, 64);
+  timebaseInit();
+  irInit();
+  __bis_SR_register(GIE);
+  patternState = patternRGB;
+
+  testPresses(testRainbowCycle, "rainbowCycle(5)");
+  testPresses(testRainbow, "rainbow(15)");
+  testRepeats();
+  testWrappedGap();
+
+  return (testFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+/*
+ * test_matrix.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * matrixIndex() and the zones (matrix.c), on the wire.  Built once for
+ * each MATRIX_LAYOUT and MATRIX_ROTATION, see the Makefile.
+ *
+ *  1. Draw a picture with every cell a different color, through
+ *     matrixIndex(), and show() it.  Walk the frame in wire order as the
+ *     panel is wired (row by row, serpentine rows coming back) and check
+ *     each LED shows the cell the rotated picture puts there: picture
+ *     (0, 0) in the corner the rotation turns the top left to, x and y
+ *     running the way it turns them.  Off the picture draws nothing.
+ *  2. matrixZones() with a different instance on each zone: a solid color
+ *     on the matrix, a rainbow on the tail.  Every frame, each zone must
+ *     show only its own pattern, and only the tail may move.
+ *  3. The 2D plasma given to the tail and a solid color to the matrix:
+ *     plasma draws the matrix whatever zone it is on, so it must be
+ *     clipped to the tail, which leaves it dark, and the matrix solid.
+ */
+
+#include <stdio.h>
+#include <msp430f2272.h>
+#include "main.h"
+#include "patterns.h"
+#include "colormath.h"
+#include "matrix.h"
+#include "scheduler.h"
+#include "WS2812B_Strip.h"
+
+#define TEST_FRAMES  300
+
+extern struct WS2812B_Strip strip;
+
+static struct HostFrame testFrames[TEST_FRAMES];
+static uint16_t testFrameCount;
+static int testFailures;
+
+// Where picture (0, 0) lands on the panel, and which way picture x and y
+// run there, for each MATRIX_ROTATION (quarter turns clockwise.)
+static const struct {
+  uint8_t left, top;     // Corner: 1 = right/bottom.
+  int8_t xColumn, xRow;
+  int8_t yColumn, yRow;
+} testTurns[4] = {
+  { 0, 0,  1,  0,  0,  1 },
+  { 1, 0,  0,  1, -1,  0 },
+  { 1, 1, -1,  0,  0, -1 },
+  { 0, 1,  0, -1,  1,  0 },
+};
+
+
+static void testOnFrame(const struct HostFrame *frame)
+{
+  if (testFrameCount < TEST_FRAMES)
+    testFrames[testFrameCount] = *frame;
+  testFrameCount++;
+}
+
+
+static uint32_t testCellColor(uint8_t x, uint8_t y) { return color(x + 1, y + 1, 0x40); }
+
+
+static uint32_t testPixel(const struct HostFrame *frame, uint16_t p)
+{
+  return ((uint32_t)frame->data[3 * p + 1] << 16) | ((uint32_t)frame->data[3 * p] << 8) | frame->data[3 * p + 2];
+}
+
+
+static void testCheck(bool ok, const char *what)
+{
+  if (ok == false)
+  {
+    testFailures++;
+    printf("FAIL test_matrix: layout %u rotation %u: %s\n", MATRIX_LAYOUT, MATRIX_ROTATION, what);
+  }
+}
+
+//******************************************************************************
+//  1. The mapping.
+//******************************************************************************
+
+// The cell of the picture at panel (column, row), from the turn alone.
+static uint32_t testWanted(int16_t column, int16_t row)
+{
+  int16_t originColumn = testTurns[MATRIX_ROTATION].left ? MATRIX_WIDTH - 1 : 0;
+  int16_t originRow = testTurns[MATRIX_ROTATION].top ? MATRIX_HEIGHT - 1 : 0;
+  int16_t x, y;
+
+  for (y = 0; y < MATRIX_LOGICAL_HEIGHT; y++)
+  {
+    for (x = 0; x < MATRIX_LOGICAL_WIDTH; x++)
+    {
+      if ((originColumn + x * testTurns[MATRIX_ROTATION].xColumn + y * testTurns[MATRIX_ROTATION].yColumn == column)
+          && (originRow + x * testTurns[MATRIX_ROTATION].xRow + y * testTurns[MATRIX_ROTATION].yRow == row))
+        return testCellColor(x, y);
+    }
+  }
+  return 0xFFFFFFFF;  // Nothing of the picture lands there.
+}
+
+
+static void testMapping(void)
+{
+  const struct HostFrame *frame = &testFrames[0];
+  int16_t column = 0, row = 0, direction = 1;
+  uint16_t p;
+  uint8_t x, y;
+  bool inOrder = true, outside = true;
+
+  create(&strip, NUMBER_OF_PIXELS);
+  for (y = 0; y < MATRIX_LOGICAL_HEIGHT; y++)
+  {
+    for (x = 0; x < MATRIX_LOGICAL_WIDTH; x++)
+      setPixelColor(&strip, matrixIndex(x, y), testCellColor(x, y));
+  }
+  setPixelColor(&strip, matrixIndex(MATRIX_LOGICAL_WIDTH, 0), RED);
+  setPixelColor(&strip, matrixIndex(0, MATRIX_LOGICAL_HEIGHT), RED);
+
+  testFrameCount = 0;
+  show(&strip);
+  hostFlush();
+  testCheck((testFrameCount == 1) && (frame->bytes == 3 * NUMBER_OF_PIXELS), "not one whole frame");
+  if (testFailures)
+    return;
+
+  //  Walk the wire.
+  for (p = 0; p < NUMBER_OF_PIXELS; p++)
+  {
+    if ((p < MATRIX_FIRST_PIXEL) || (p >= MATRIX_FIRST_PIXEL + MATRIX_PIXELS))
+    {
+      outside &= (testPixel(frame, p) == 0);
+      continue;
+    }
+    if (testPixel(frame, p) != testWanted(column, row))
+    {
+      inOrder = false;
+      printf("     test_matrix: pixel %u (column %d, row %d) is %06X, not %06X\n",
+             p, column, row, testPixel(frame, p), testWanted(column, row));
+    }
+    column += direction;
+    if ((column < 0) || (column == MATRIX_WIDTH))
+    {
+      row++;
+      if (MATRIX_LAYOUT == MATRIX_SERPENTINE)
+      {
+        direction = -direction;
+        column += direction;
+      }
+      else
+      {
+        column = 0;
+      }
+    }
+  }
+  testCheck(inOrder, "the picture isn't on the panel the way it's wired and turned");
+  testCheck(outside, "drew off the matrix");
+
+  if (testFailures == 0)
+    printf("ok   test_matrix: %s, rotation %u: %ux%u picture in wire order on the %ux%u panel\n",
+           (MATRIX_LAYOUT == MATRIX_SERPENTINE) ? "serpentine " : "progressive", MATRIX_ROTATION,
+           MATRIX_LOGICAL_WIDTH, MATRIX_LOGICAL_HEIGHT, MATRIX_WIDTH, MATRIX_HEIGHT);
+}
+
+//******************************************************************************
+//  2. The zones.
+//******************************************************************************
+
+static void testZones(void)
+{
+  const struct HostFrame *frame;
+  uint16_t f, i, p, moved = 0;
+  uint8_t phase, lastPhase = 0;
+  bool own = true, odd = false;
+  int failures = testFailures;
+
+  create(&strip, NUMBER_OF_PIXELS);
+  timebaseInit();
+  __bis_SR_register(GIE);
+  setZonePattern(ZONE_MATRIX, zoneSolid, GREEN, 3);
+  setZonePattern(ZONE_TAIL, zoneRainbow, 0, 2);
+
+  testFrameCount = 0;
+  matrixZones(&strip, 20);
+  hostFlush();
+
+  // The first is the clear().
+  for (f = 1; (f < testFrameCount) && (f < TEST_FRAMES); f++)
+  {
+    frame = &testFrames[f];
+    for (i = 0; i < zones[ZONE_MATRIX].count; i++)
+      own &= (testPixel(frame, zones[ZONE_MATRIX].first + i) == GREEN);
+
+    // The tail's phase, from its first pixel, and the rest of it must agree.
+    p = zones[ZONE_TAIL].first;
+    for (phase = 0; (hsv(phase, 255, 255) != testPixel(frame, p)) && (phase < 255); phase++)
+      ;
+    for (i = 0; i < zones[ZONE_TAIL].count; i++)
+      own &= (testPixel(frame, p + i) == hsv((i << 4) + phase, 255, 255));
+    if ((f > 1) && (phase != lastPhase))
+      moved++;
+    odd |= (phase & 1);  // Speed 2 from 0, the matrix's 3 would make odd ones.
+    lastPhase = phase;
+  }
+  testCheck(testFrameCount > 2, "matrixZones() showed nothing");
+  testCheck(own, "a zone shows another zone's pattern");
+  testCheck(moved + 2 >= testFrameCount, "the tail's instance isn't moving every frame");
+  testCheck(odd == false, "the tail moved at the matrix's speed");
+
+  if (testFailures == failures)
+    printf("ok   test_matrix: %u frames of two zone instances, each on its own pixels\n", testFrameCount - 1);
+}
+
+
+// 3. A 2D pattern on a zone that isn't the matrix.
+static void testClipped(void)
+{
+  const struct HostFrame *frame;
+  uint16_t f, i;
+  bool matrix = true, tail = true;
+  int failures = testFailures;
+
+  create(&strip, NUMBER_OF_PIXELS);
+  setZonePattern(ZONE_MATRIX, zoneSolid, BLUE, 1);
+  setZonePattern(ZONE_TAIL, zonePlasma, 0, 1);
+
+  testFrameCount = 0;
+  matrixZones(&strip, 20);
+  hostFlush();
+
+  for (f = 1; (f < testFrameCount) && (f < TEST_FRAMES); f++)
+  {
+    frame = &testFrames[f];
+    for (i = 0; i < zones[ZONE_MATRIX].count; i++)
+      matrix &= (testPixel(frame, zones[ZONE_MATRIX].first + i) == BLUE);
+    for (i = 0; i < zones[ZONE_TAIL].count; i++)
+      tail &= (testPixel(frame, zones[ZONE_TAIL].first + i) == 0);
+  }
+  testCheck(testFrameCount > 2, "matrixZones() showed nothing");
+  testCheck(matrix, "plasma on the tail drew over the matrix");
+  testCheck(tail, "plasma drew on the tail, off the matrix");
+
+  if (testFailures == failures)
+    printf("ok   test_matrix: %u frames of plasma on the tail, clipped to it\n", testFrameCount - 1);
+}
+
+
+int main(void)
+{
+  hostReset();
+  hostTimeLimit = 0;
+  hostOnFrame = testOnFrame;
+
+  testMapping();
+  testZones();
+  testClipped();
+
+  return (testFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+/*
+ * test_ramcheck.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * ramPaint()/ramCheck() down the worst case ISR nesting path (see
+ * ramcheck.c), on a follower board so Port_2 receives sync packets.
+ *
+ * The firmware runs on a stack of its own, testRam[], which stands in for
+ * the RAM between the statics and __STACK_END (msp430f2272.h), and paints
+ * it as main() does at step 1.9.  Each run is a main() style loop of
+ * rainbowCycle(5) with, on top of it:
+ *
+ *  1. nothing,
+ *  2. a short press (Port_1 on top of the pattern),
+ *  3. a long press, so Port_1 sleeps with interrupts on, then a sync
+ *     packet (Port_2 on top of Port_1),
+ *  4. a long press, then a short press to wake up (Port_1 on top of
+ *     Port_1.)
+ *
+ * 3 and 4 must nest two deep and no deeper, each run must be deeper than
+ * the one before it (3 and 4 against 2), and what ramCheck() says must add
+ * up to testRam[].  The same numbers must come back over I2C.
+ *
+ * These are host stack bytes, x86-64 frames are several times the F2272's,
+ * so the ratios between the runs are the useful part, not the sizes.
+ */
+
+#include <stdio.h>
+#include <ucontext.h>
+#include <msp430f2272.h>
+#include "main.h"
+#include "patterns.h"
+#include "scheduler.h"
+#include "sync.h"
+#include "i2c.h"
+#include "ramcheck.h"
+#include "WS2812B_Strip.h"
+
+#define TEST_RAM_WORDS  (16 * 1024)
+#define TEST_PERIOD     5         // ms, rainbowCycle(5) as in main.c.
+#define TEST_RUNS       4
+
+extern struct WS2812B_Strip strip;
+
+static uint16_t testRam[TEST_RAM_WORDS];
+static ucontext_t testHost, testFirmware;
+static bool testDone;
+static int testFailures;
+
+struct TestRun {
+  const char *name;
+  uint32_t pressMs, holdMs;   // 0 = no press.
+  uint32_t packetMs;          // Sync packet, 0 = none.
+  uint32_t wakeMs;            // Short press to wake up, 0 = none.
+  uint32_t stopMs;
+};
+
+static const struct TestRun testRuns[TEST_RUNS] = {
+  { "pattern",                 0,    0,    0,    0, 2000 },
+  { "+ short press",         500,  200,    0,    0, 3000 },
+  { "+ asleep + sync packet", 500, 3200, 7500,    0, 9000 },
+  { "+ asleep + wake press",  500, 3200,    0, 7500, 11000 },
+};
+
+//******************************************************************************
+//  Inputs.
+//******************************************************************************
+
+static void testRelease(uint32_t unused)
+{
+  P1IN |= PSC_SW_PIN;
+}
+
+
+static void testPress(uint32_t holdMs)
+{
+  P1IN &= ~PSC_SW_PIN;
+  hostSchedule(hostCycles + (uint64_t)holdMs * HOST_CYCLES_PER_MS, testRelease, 0);
+  hostRaise(PORT1_VECTOR);
+}
+
+
+// Bit bang one packet onto the sync line, as a master would.
+static void testPacket(uint32_t unused)
+{
+  uint8_t bytes[6] = { SYNC_HEADER, 0, 0, patternRainbowCycle, 64, 0 };
+  uint64_t at = hostCycles;
+  uint8_t i, bit;
+
+  bytes[5] = ~(uint8_t)(bytes[1] + bytes[2] + bytes[3] + bytes[4]);
+  for (i = 0; i < sizeof(bytes); i++)
+  {
+    hostSchedule(at, hostSyncLevel, 0);  // Start bit.
+    at += SYNC_BIT_CYCLES;
+    for (bit = 0; bit < 8; bit++, at += SYNC_BIT_CYCLES)
+      hostSchedule(at, hostSyncLevel, (bytes[i] >> bit) & 0x01);
+    hostSchedule(at, hostSyncLevel, 1);  // Stop bit.
+    at += SYNC_BIT_CYCLES;
+  }
+}
+
+
+// A packet also wakes main() if it is still asleep in frameWait(): the
+// long press put it to sleep with TBCCTL0 off.
+static void testStop(uint32_t unused)
+{
+  testDone = true;
+  strip.breakFromPattern = true;
+  testPacket(0);
+}
+
+//******************************************************************************
+//  The board, on testRam[].
+//******************************************************************************
+
+static void testBoard(void)
+{
+  create(&strip, NUMBER_OF_PIXELS);
+  show(&strip);
+  setBrightness(&strip, 64);
+  timebaseInit();
+  syncInit();
+  i2cInit(&strip);
+  PSC_SW_PORT_IE |= PSC_SW_PIN;
+  P1IN |= PSC_SW_PIN;
+  patternState = patternRainbowCycle;
+
+  ramPaint();
+  __bis_SR_register(GIE);
+
+  while (testDone == false)
+  {
+    strip.breakFromPattern = false;
+    rainbowCycle(&strip, TEST_PERIOD);
+  }
+  hostFlush();
+}
+
+
+static void testRun(const struct TestRun *run, struct RamUsage *usage)
+{
+  hostReset();
+  hostTimeLimit = 0;
+  hostRamStart = hostRamStaticEnd = testRam;
+  hostStackEnd = testRam + TEST_RAM_WORDS;
+
+  testDone = false;
+  if (run->pressMs)
+    hostSchedule((uint64_t)run->pressMs * HOST_CYCLES_PER_MS, testPress, run->holdMs);
+  if (run->packetMs)
+    hostSchedule((uint64_t)run->packetMs * HOST_CYCLES_PER_MS, testPacket, 0);
+  if (run->wakeMs)
+    hostSchedule((uint64_t)run->wakeMs * HOST_CYCLES_PER_MS, testPress, 200);
+  hostSchedule((uint64_t)run->stopMs * HOST_CYCLES_PER_MS, testStop, 0);
+
+  getcontext(&testFirmware);
+  testFirmware.uc_stack.ss_sp = testRam;
+  testFirmware.uc_stack.ss_size = sizeof(testRam);
+  testFirmware.uc_link = &testHost;
+  makecontext(&testFirmware, testBoard, 0);
+  swapcontext(&testHost, &testFirmware);
+
+  ramCheck(usage);
+}
+
+//******************************************************************************
+//  The same numbers over I2C.
+//******************************************************************************
+
+static uint8_t testI2cRead(void)
+{
+  hostRaise(USCIAB0TX_VECTOR);
+  hostRunUntil(hostCycles + 1);
+  return UCB0TXBUF;
+}
+
+
+static bool testI2cMatches(const struct RamUsage *usage)
+{
+  uint16_t staticBytes, stackPeak, headroom;
+
+  __bis_SR_register(GIE);
+  hostI2cByte(I2C_REG_RAM_STATIC_LOW | HOST_I2C_START);
+  hostRunUntil(hostCycles + 1);
+  staticBytes = testI2cRead();
+  staticBytes |= testI2cRead() << 8;
+  stackPeak = testI2cRead();
+  stackPeak |= testI2cRead() << 8;
+  headroom = testI2cRead();
+  headroom |= testI2cRead() << 8;
+
+  return (staticBytes == usage->staticBytes) && (stackPeak == usage->stackPeak)
+         && (headroom == usage->headroom);
+}
+
+//******************************************************************************
+//  The tests.
+//******************************************************************************
+
+static void testCheck(bool ok, const char *what)
+{
+  if (ok == false)
+  {
+    testFailures++;
+    printf("FAIL test_ramcheck: %s\n", what);
+  }
+}
+
+
+int main(void)
+{
+  static const uint8_t depth[TEST_RUNS] = { 1, 1, 2, 2 };
+  struct RamUsage usage[TEST_RUNS];
+  uint8_t nesting[TEST_RUNS], r;
+
+  for (r = 0; r < TEST_RUNS; r++)
+  {
+    testRun(&testRuns[r], &usage[r]);
+    nesting[r] = hostDeepestNesting;
+
+    printf("     test_ramcheck: %-24s %u deep, stack peak %5u, headroom %5u of %u host bytes\n",
+           testRuns[r].name, nesting[r], usage[r].stackPeak, usage[r].headroom,
+           (unsigned)sizeof(testRam));
+    testCheck(nesting[r] == depth[r], "ISRs nested deeper or shallower than expected");
+    testCheck(usage[r].stackPeak + usage[r].headroom == sizeof(testRam), "stack peak + headroom isn't all of RAM");
+    testCheck(usage[r].headroom != 0, "ran out of testRam[]");
+  }
+  testCheck(usage[1].stackPeak > usage[0].stackPeak, "a press isn't deeper than the pattern alone");
+  testCheck(usage[2].stackPeak > usage[1].stackPeak, "Port_2 on a sleeping Port_1 isn't the deeper path");
+  testCheck(usage[3].stackPeak > usage[1].stackPeak, "Port_1 on a sleeping Port_1 isn't the deeper path");
+  testCheck(testI2cMatches(&usage[3]), "I2C_REG_RAM_* don't read back ramCheck()");
+
+  if (testFailures == 0)
+    printf("ok   test_ramcheck: worst case %u host bytes, %.1f x the pattern alone, read back over I2C\n",
+           (usage[2].stackPeak > usage[3].stackPeak) ? usage[2].stackPeak : usage[3].stackPeak,
+           (double)((usage[2].stackPeak > usage[3].stackPeak) ? usage[2].stackPeak : usage[3].stackPeak)
+           / usage[0].stackPeak);
+  return (testFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+/*
+ * test_ring.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * rotatePixels() and the wrap in transmit(), on the wire.  For every
+ * rotation of a few strip lengths: draw a different color on every pixel,
+ * rotate, redraw pixel 0 through ringIndex() and show().  There must be
+ * one frame, in ring order, with pixel 0 the redrawn one, and no low in
+ * it anywhere near the 50us the LEDs take as a reset.
+ *
+ * The wrap check in transmit() charges its cycles (CODE_CYCLES()), so the
+ * longest low of every rotated frame must be exactly the unrotated frame's:
+ * the byte boundary it wraps at is no longer than any other.  The last
+ * byte of the buffer ends on a Zero for 38 and 16 pixels and on a One for
+ * 5, so both places the check can be are covered.
+ */
+
+#include <stdio.h>
+#include <msp430f2272.h>
+#include "main.h"
+#include "patterns.h"
+#include "WS2812B_Strip.h"
+
+#define TEST_FRAMES  2
+#define TEST_MARKER  0x5A5A5A
+
+extern struct WS2812B_Strip strip;
+
+static struct HostFrame testFrames[TEST_FRAMES];
+static uint8_t testFrameCount;
+
+
+static void testOnFrame(const struct HostFrame *frame)
+{
+  if (testFrameCount < TEST_FRAMES)
+    testFrames[testFrameCount] = *frame;
+  testFrameCount++;
+}
+
+
+static uint32_t testPixelColor(uint16_t i) { return color(i + 1, 0x80 ^ i, 0xFF - i); }
+
+
+// Is 'frame' the strip rotated by 'offset', with pixel 0 redrawn?
+static bool testInRingOrder(const struct HostFrame *frame, uint16_t pixels, uint16_t offset)
+{
+  uint32_t want;
+  uint16_t p;
+
+  if ((frame->bytes != 3 * pixels) || (frame->bits != 0))
+    return false;
+  for (p = 0; p < pixels; p++)
+  {
+    want = (p == 0) ? TEST_MARKER : testPixelColor((p + offset) % pixels);
+    if ((frame->data[3 * p] != (uint8_t)(want >> 8)) || (frame->data[3 * p + 1] != (uint8_t)(want >> 16))
+        || (frame->data[3 * p + 2] != (uint8_t)want))
+      return false;
+  }
+  return true;
+}
+
+
+// Every rotation of a 'pixels' long strip, returns the failures.
+static uint16_t testLength(uint16_t pixels)
+{
+  uint16_t offset, i, failures = 0;
+  uint32_t unrotatedLow = 0, longestLow = 0;
+
+  for (offset = 0; offset < pixels; offset++)
+  {
+    create(&strip, pixels);
+    for (i = 0; i < pixels; i++)
+      setPixelColor(&strip, i, testPixelColor(i));
+    rotatePixels(&strip, offset);
+    setPixelColor(&strip, ringIndex(&strip, 0), TEST_MARKER);
+
+    testFrameCount = 0;
+    show(&strip);
+    hostFlush();
+
+    if ((testFrameCount != 1) || (testInRingOrder(&testFrames[0], pixels, offset) == false)
+        || (testFrames[0].longestLow >= HOST_RESET_CYCLES)
+        || ((offset != 0) && (testFrames[0].longestLow != unrotatedLow)))
+    {
+      failures++;
+      printf("FAIL test_ring: %u pixels rotated by %u, %u frames, longest low %u cycles (%u unrotated)\n",
+             pixels, offset, testFrameCount, testFrames[0].longestLow, unrotatedLow);
+      continue;
+    }
+    if (offset == 0)
+      unrotatedLow = testFrames[0].longestLow;
+    else if (testFrames[0].longestLow > longestLow)
+      longestLow = testFrames[0].longestLow;
+  }
+
+  if (failures == 0)
+    printf("ok   test_ring: %2u pixels, every rotation in ring order, longest low %u cycles (%u unrotated)\n",
+           pixels, longestLow, unrotatedLow);
+  return failures;
+}
+
+
+int main(void)
+{
+  uint16_t failures;
+
+  hostReset();
+  hostTimeLimit = 0;
+  hostOnFrame = testOnFrame;
+
+  failures = testLength(NUMBER_OF_PIXELS);
+  failures += testLength(16);
+  failures += testLength(5);
+
+  return (failures == 0) ? 0 : 1;
+}
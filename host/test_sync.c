@@ -0,0 +1,297 @@
+/*
+ * test_sync.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * Several boards on one sync wire.  The host runs one MCU at a time, so
+ * this is built twice (see the Makefile):
+ *
+ *  test_sync_master: SYNC_ROLE = SYNC_MASTER runs rainbowCycle() and
+ *    records every edge it drives on the wire and every frame it shows,
+ *    into TEST_SYNC_TRACE.
+ *  test_sync: SYNC_ROLE = SYNC_FOLLOWER boards are fed that wire, each
+ *    with a different interrupt latency (ISR prologue, waking up), and
+ *    with every TEST_SYNC_DROP'th packet lost.  Every frame a follower
+ *    shows must be one the master showed, within TEST_SYNC_SKEW_US of it:
+ *    the ones from a packet and the ones from its own deadline.  (Those
+ *    also wake up through the follower's latency, which the master was
+ *    recorded without, so that much more is allowed.)
+ *
+ *  Then a packet for a step behind the follower's: it must hold its frame
+ *  (advance 0) until the master gets to its next step, not restart the
+ *  pattern, unless the master's step is one of its first, which is a
+ *  master that has started over.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <msp430f2272.h>
+#include "main.h"
+#include "patterns.h"
+#include "scheduler.h"
+#include "sync.h"
+#include "WS2812B_Strip.h"
+
+#define TEST_SYNC_TRACE    "build/sync_master.txt"
+#define TEST_SYNC_FRAMES   120
+#define TEST_SYNC_PERIOD   5         // ms, rainbowCycle(5) as in main.c.
+#define TEST_SYNC_DROP     5
+#define TEST_SYNC_SKEW_US  8         // One bit.
+#define TEST_SYNC_GAP      10000     // Cycles between edges of two packets.
+#define TEST_SYNC_EDGES    6000
+
+extern struct WS2812B_Strip strip;
+
+static FILE *testTrace;
+static bool testDone;
+
+struct TestFrame {
+  uint64_t start;
+  uint32_t hash;
+};
+
+
+static uint32_t testHash(const struct HostFrame *frame)
+{
+  uint32_t hash = 2166136261u;
+  uint16_t i;
+
+  for (i = 0; i < frame->bytes; i++)
+    hash = (hash ^ frame->data[i]) * 16777619u;
+  return hash;
+}
+
+
+static void testStop(uint32_t unused)
+{
+  testDone = true;
+  strip.breakFromPattern = true;
+}
+
+
+// The same start up as main(), for either role.
+static void testBoard(void)
+{
+  create(&strip, NUMBER_OF_PIXELS);
+  show(&strip);
+  setBrightness(&strip, 64);
+  timebaseInit();
+  syncInit();
+  __bis_SR_register(GIE);
+  patternState = patternRainbowCycle;
+
+  testDone = false;
+  hostSchedule((uint64_t)TEST_SYNC_FRAMES * TEST_SYNC_PERIOD * HOST_CYCLES_PER_MS, testStop, 0);
+  while (testDone == false)
+  {
+    strip.breakFromPattern = false;
+    rainbowCycle(&strip, TEST_SYNC_PERIOD);
+  }
+  hostFlush();
+}
+
+
+#if SYNC_ROLE == SYNC_MASTER
+
+static void testMasterEdge(bool level, uint64_t cycle)
+{
+  fprintf(testTrace, "e %llu %d\n", (unsigned long long)cycle, level);
+}
+
+
+static void testMasterFrame(const struct HostFrame *frame)
+{
+  fprintf(testTrace, "f %llu %08X\n", (unsigned long long)frame->start, testHash(frame));
+}
+
+
+int main(void)
+{
+  testTrace = fopen(TEST_SYNC_TRACE, "w");
+  if (testTrace == NULL)
+  {
+    perror(TEST_SYNC_TRACE);
+    return 1;
+  }
+
+  hostReset();
+  hostOnSyncOut = testMasterEdge;
+  hostOnFrame = testMasterFrame;
+  testBoard();
+  fclose(testTrace);
+
+  printf("ok   test_sync_master: %u frames recorded\n", strip.frame.framesShown);
+  return 0;
+}
+
+#else
+
+static struct TestFrame testMaster[TEST_SYNC_FRAMES + 16];
+static uint16_t testMasterFrames;
+static uint64_t testEdgeCycle[TEST_SYNC_EDGES];
+static uint8_t testEdgeLevel[TEST_SYNC_EDGES];
+static uint16_t testEdges;
+static int32_t testSkewMin, testSkewMax;
+static uint16_t testMatched, testStrays;
+static uint64_t testSynced;      // First packet the follower took, 0 = none.
+
+
+static void testLoadTrace(void)
+{
+  unsigned long long cycle;
+  unsigned hash;
+  int level;
+  char kind;
+
+  testTrace = fopen(TEST_SYNC_TRACE, "r");
+  if (testTrace == NULL)
+  {
+    perror(TEST_SYNC_TRACE " (test_sync_master writes it)");
+    exit(1);
+  }
+  while (fscanf(testTrace, " %c %llu", &kind, &cycle) == 2)
+  {
+    if ((kind == 'e') && (fscanf(testTrace, "%d", &level) == 1) && (testEdges < TEST_SYNC_EDGES))
+    {
+      testEdgeCycle[testEdges] = cycle;
+      testEdgeLevel[testEdges++] = level;
+    }
+    else if ((kind == 'f') && (fscanf(testTrace, "%x", &hash) == 1)
+             && (testMasterFrames < sizeof(testMaster) / sizeof(testMaster[0])))
+    {
+      testMaster[testMasterFrames].start = cycle;
+      testMaster[testMasterFrames++].hash = hash;
+    }
+  }
+  fclose(testTrace);
+}
+
+
+// The wire as the master drove it, less every TEST_SYNC_DROP'th packet.
+static void testScheduleWire(void)
+{
+  uint16_t i, packet = 0;
+
+  for (i = 0; i < testEdges; i++)
+  {
+    if ((i > 0) && (testEdgeCycle[i] - testEdgeCycle[i - 1] > TEST_SYNC_GAP))
+      packet++;
+    if ((packet % TEST_SYNC_DROP) == TEST_SYNC_DROP - 1)
+      continue;
+    hostSchedule(testEdgeCycle[i], hostSyncLevel, testEdgeLevel[i]);
+  }
+}
+
+
+// Match each frame from after the first packet it took to the master's.
+// Frames are decoded a frame late, so syncTime can already be the next
+// packet's, which only skips one more.
+static void testFollowerFrame(const struct HostFrame *frame)
+{
+  uint32_t hash = testHash(frame);
+  int32_t skew;
+  uint16_t i;
+
+  if ((testSynced == 0) && (strip.frame.syncTime != 0))
+    testSynced = (uint64_t)strip.frame.syncTime * (HOST_CYCLES_PER_MS / TIMEBASE_TICKS_PER_MS);
+  if ((testSynced == 0) || (frame->start < testSynced))
+    return;
+  for (i = 0; i < testMasterFrames; i++)
+  {
+    if ((testMaster[i].hash == hash) && (testMaster[i].start + 2 * TEST_SYNC_PERIOD * HOST_CYCLES_PER_MS > frame->start)
+        && (frame->start + 2 * TEST_SYNC_PERIOD * HOST_CYCLES_PER_MS > testMaster[i].start))
+      break;
+  }
+  if (i == testMasterFrames)
+  {
+    testStrays++;
+    return;
+  }
+
+  skew = (int32_t)(frame->start - testMaster[i].start);
+  if ((testMatched == 0) || (skew < testSkewMin))
+    testSkewMin = skew;
+  if ((testMatched == 0) || (skew > testSkewMax))
+    testSkewMax = skew;
+  testMatched++;
+}
+
+
+// frameWait() on a packet for 'syncStep' with the follower at step 10.
+static uint16_t testBehind(uint16_t syncStep)
+{
+  strip.breakFromPattern = false;
+  frameBegin(&strip, TEST_SYNC_PERIOD);
+  strip.frame.step = 10;
+  strip.frame.syncTime = timebaseNow();
+  strip.frame.syncStep = syncStep;
+  strip.frame.syncPending = true;
+  return frameWait(&strip);
+}
+
+
+static bool testHold(void)
+{
+  uint32_t period, held;
+  uint16_t advance;
+  bool ok, restarted;
+
+  hostReset();
+  create(&strip, NUMBER_OF_PIXELS);
+  timebaseInit();
+  __bis_SR_register(GIE);
+
+  // 5 steps ahead: same step again, next one when the master starts step 11.
+  advance = testBehind(5);
+  period = strip.frame.period;
+  held = strip.frame.deadline - strip.frame.syncTime;
+  ok = (advance == 0) && (strip.frame.step == 10) && (held == 6 * period) && (strip.breakFromPattern == false);
+  printf("%s test_sync: 5 steps ahead, advance %u, step %u, next frame in %lu periods, %s\n",
+         ok ? "ok  " : "FAIL", advance, strip.frame.step, (unsigned long)(held / period),
+         strip.breakFromPattern ? "restarted" : "held");
+
+  // The master is back on its step 1: start over with it.
+  advance = testBehind(1);
+  restarted = (advance == 1) && strip.breakFromPattern;
+  printf("%s test_sync: master started over, %s\n", restarted ? "ok  " : "FAIL",
+         strip.breakFromPattern ? "restarted" : "held");
+  return ok && restarted;
+}
+
+
+int main(void)
+{
+  static const uint16_t latencies[] = { 0, 20, 40, 60, 80, 100 };
+  uint8_t i;
+  int failures = 0;
+  bool ok;
+
+  testLoadTrace();
+  for (i = 0; i < sizeof(latencies) / sizeof(latencies[0]); i++)
+  {
+    hostReset();
+    hostInterruptLatency = latencies[i];
+    hostOnFrame = testFollowerFrame;
+    testMatched = testStrays = 0;
+    testSynced = 0;
+    testSkewMin = testSkewMax = 0;
+    testScheduleWire();
+    hostRunUntil(i * 1700 * HOST_CYCLES_PER_US + 300 * HOST_CYCLES_PER_US);  // Boot later than the master.
+    testBoard();
+
+    ok = (testStrays == 0) && (testMatched > TEST_SYNC_FRAMES - 10)
+         && (testSkewMin > -TEST_SYNC_SKEW_US * HOST_CYCLES_PER_US)
+         && (testSkewMax < TEST_SYNC_SKEW_US * HOST_CYCLES_PER_US + latencies[i]);
+    if (ok == false)
+      failures++;
+    printf("%s test_sync: latency %3u cycles, %u frames matched, %u not, skew %+.1f to %+.1fus\n",
+           ok ? "ok  " : "FAIL", latencies[i], testMatched, testStrays,
+           (double)testSkewMin / HOST_CYCLES_PER_US, (double)testSkewMax / HOST_CYCLES_PER_US);
+  }
+  if (testHold() == false)
+    failures++;
+  return (failures == 0) ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,368 @@
+/*
+ * i2c.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * I2C target on USCI_B0, so a host processor can set the pattern and
+ * brightness, or push its own pixels, instead of using the buttons.
+ *
+ * The register map is in i2c.h.  The host selects patternHost, then writes
+ * [WINDOW_LOW] [lo] [hi] [r g b r g b...] and finally [SHOW] [1].  The
+ * data ISR scales each color byte by the brightness and stores it straight
+ * into the back buffer (strip->pixels[]), at the buffer's own G, R, B
+ * positions, so a burst costs no RAM beyond the strip itself.  hostPixels()
+ * then only has to call show().
+ *
+ * CLOCK STRETCHING:
+ *  The USCI holds SCL low on its own whenever a byte is waiting in
+ *  UCB0RXBUF and the next one has come in.  Nothing is dropped; the host
+ *  just waits.  Two cases use that:
+ *  - hostPixels() calls show() with interrupts off, so they stay off for
+ *    its front to back buffer copy as well (DOUBLE.)  The ISR can't run, so
+ *    a burst stalls until show() is done with pixels[].
+ *  - Pixel data arrives while some other pattern is drawing into pixels[].
+ *    The ISR selects patternHost and masks its receive interrupt without
+ *    reading the byte, and hostPixels() unmasks it once it owns the
+ *    buffer.  Both frameWait() and delay_ms() give up on breakFromPattern,
+ *    so that is the rest of the old pattern's current frame, ~3ms for
+ *    patternRGB.  Hosts with a clock stretch timeout should select
+ *    patternHost themselves first.
+ *
+ * START AND STOP:
+ *  Both interrupt on the USCIAB0RX vector (UCSTTIE, UCSTPIE), ahead of the
+ *  data byte on USCIAB0TX, and make the next byte a register.  A write can
+ *  end (STOP) on a byte we are still holding, with the next transaction's
+ *  START before we take it: that byte was sent before the condition, so it
+ *  is still data and the register comes after it.  The same goes for a
+ *  lone STOP with a byte waiting, after interrupts have been off.  With
+ *  interrupts off through both a STOP and a START (a show()), the waiting
+ *  byte is taken as the new register, which it is unless the old write's
+ *  last byte landed during that show() too.
+ *
+ * THROUGHPUT:
+ *  ~100 cycles per pixel byte in the ISR (~6us at 16MHz, +scale8() under
+ *  full brightness), against 22.5us per byte on a 400kHz bus, so uploads
+ *  run at bus speed: ~14000 pixels/s.  All 38 pixels on the hat are
+ *  ~118 bytes, ~2.7ms, plus ~1.2ms stretched for show(), so back to back
+ *  uploads of the whole hat come to ~9800 pixels/s (host/test_i2c.c.)
+ */
+
+#include <msp430f2272.h>
+#include "i2c.h"
+#include "colormath.h"
+#include "ir.h"
+#include "ramcheck.h"
+
+// Buffer offset of each color byte the host sends (R, G, B) within a
+// pixel, which is stored G, R, B (see setPixelColor()).
+static const uint8_t i2cChannelOffset[3] = { 1, 0, 2 };
+
+static struct WS2812B_Strip *i2cStrip;
+static uint8_t i2cRegister;
+static uint16_t i2cWindow;
+static uint16_t i2cCursor;      // Pixel the next I2C_REG_PIXELS byte goes to,
+static uint8_t i2cChannel;      // and which of its R, G, B.
+static volatile bool i2cShowPending;
+static bool i2cHostActive;      // hostPixels() owns pixels[].
+static bool i2cRegisterNext;    // Next byte is a register (START/STOP),
+static bool i2cEndAfterByte;    // or the one after the byte waiting is.
+static uint8_t i2cBrightness;   // For i2cPoll() to setBrightness(),
+static volatile bool i2cBrightnessPending;
+
+static bool i2cReceive(void);
+static uint8_t i2cTransmit(void);
+
+
+// Become I2C_ADDRESS on USCI_B0.  Pixel writes go to 'strip'.
+//
+// PSUEDO:
+//  1. Hold the USCI in reset while setting it up.
+//  2. I2C target, 7-bit address.
+//  3. Hand it the pins, release it, and interrupt on every byte, START and
+//     STOP.
+void i2cInit(struct WS2812B_Strip *strip)
+{
+  i2cStrip = strip;
+  i2cRegister = I2C_REG_PATTERN;
+  i2cRegisterNext = true;
+  i2cEndAfterByte = false;
+  i2cShowPending = false;
+  i2cBrightnessPending = false;
+
+  //  1. Hold the USCI in reset while setting it up.
+  UCB0CTL1 |= UCSWRST;
+
+  //  2. I2C target, 7-bit address.
+  UCB0CTL0 = UCMODE_3 | UCSYNC;
+  UCB0I2COA = I2C_ADDRESS;
+
+  //  3. Hand it the pins, release it, and interrupt on every byte, START and
+  //     STOP.
+  I2C_PORT_SEL |= I2C_SDA_PIN | I2C_SCL_PIN;
+  UCB0CTL1 &= ~UCSWRST;
+  UCB0I2CIE = UCSTPIE | UCSTTIE;
+  IE2 |= UCB0RXIE | UCB0TXIE;
+}
+
+
+// Drop off the bus, so the host can't wake the CPU.
+void i2cStop(void)
+{
+  IE2 &= ~(UCB0RXIE | UCB0TXIE);
+  UCB0I2CIE = 0;
+  UCB0CTL1 |= UCSWRST;
+  I2C_PORT_SEL &= ~(I2C_SDA_PIN | I2C_SCL_PIN);
+}
+
+
+
+// Apply what the host has written that the ISR can't, from main context
+// (frameWait(), delay_ms() and the patterns' own waits, next to irPoll().)
+void i2cPoll(struct WS2812B_Strip *strip)
+{
+  uint8_t brightness;
+
+  if (i2cBrightnessPending == false)
+    return;
+  __bic_SR_register(GIE);
+  brightness = i2cBrightness;
+  i2cBrightnessPending = false;
+  __bis_SR_register(GIE);
+  setBrightness(strip, brightness);
+}
+
+//******************************************************************************
+//******************************************************************************
+//  PATTERNS
+//******************************************************************************
+//******************************************************************************
+
+
+// Show whatever the host has uploaded, each time it writes I2C_REG_SHOW.
+//
+// PSUEDO:
+//  1. Start from a blank strip, then let in any pixels the ISR held back.
+//  2. Sleep until the host asks for a show().
+//  3. show() with interrupts off throughout, so the bus stalls instead.
+void hostPixels(struct WS2812B_Strip *strip)
+{
+  //  1. Start from a blank strip, then let in any pixels the ISR held back.
+  clear(strip);
+  show(strip);
+  i2cHostActive = true;
+  IE2 |= UCB0RXIE;
+
+  while (strip->breakFromPattern == false)
+  {
+    //  2. Sleep until the host asks for a show().
+    __bic_SR_register(GIE);
+    if (i2cShowPending == false)
+      __bis_SR_register(LPM0_bits | GIE);  // I2C (or any other) ISR wakes us.
+    __bis_SR_register(GIE);
+
+    irPoll(strip);
+    i2cPoll(strip);
+
+    //  3. show() with interrupts off throughout, so the bus stalls instead.
+    if (i2cShowPending)
+    {
+      __bic_SR_register(GIE);
+      show(strip);
+      i2cShowPending = false;
+      __bis_SR_register(GIE);
+    }
+  }
+  i2cHostActive = false;
+
+  strip->inInterrupt = false;
+  return;
+}
+
+//******************************************************************************
+//******************************************************************************
+//   I2C HELPER FUNCTIONS
+//******************************************************************************
+//******************************************************************************
+
+// One byte from the host.  Returns true if the main loop needs waking.
+//
+// PSUEDO:
+//  1. First byte after a START or STOP is the register.
+//  2. Pixels while another pattern owns pixels[]: switch to patternHost and
+//     leave the byte in UCB0RXBUF, so the bus stalls until it is ready.
+//  3. Write the register, then move on to the next one.  If the write
+//     ended on this byte, the next is a register.
+static bool i2cReceive(void)
+{
+  struct WS2812B_Strip *strip = i2cStrip;
+  uint8_t value;
+  uint16_t pixel;
+  bool wake = false;
+
+  //  1. First byte after a START or STOP is the register.
+  if (i2cRegisterNext)
+  {
+    i2cRegister = UCB0RXBUF;
+    i2cRegisterNext = i2cEndAfterByte;
+    i2cEndAfterByte = false;
+    return false;
+  }
+
+  //  2. Pixels while another pattern owns pixels[]: switch to patternHost and
+  //     leave the byte in UCB0RXBUF, so the bus stalls until it is ready.
+  if ((i2cRegister == I2C_REG_PIXELS) && (i2cHostActive == false))
+  {
+    IE2 &= ~UCB0RXIE;
+    if (patternState != patternHost)
+    {
+      patternState = patternHost;
+      strip->breakFromPattern = true;
+    }
+    return true;
+  }
+
+  //  3. Write the register, then move on to the next one.  If the write
+  //     ended on this byte, the next is a register.
+  value = UCB0RXBUF;
+  i2cRegisterNext = i2cEndAfterByte;
+  i2cEndAfterByte = false;
+  switch (i2cRegister)
+  {
+    case I2C_REG_PATTERN:
+      if ((value < NUMBER_OF_PATTERNS) && (value != patternState))
+      {
+        patternState = (enum pattern)value;
+        strip->breakFromPattern = true;
+        wake = true;
+      }
+      break;
+    case I2C_REG_BRIGHTNESS:
+      i2cBrightness = value;
+      i2cBrightnessPending = true;
+      wake = true;
+      break;
+    case I2C_REG_WINDOW_LOW:
+      i2cWindow = (i2cWindow & 0xFF00) | value;
+      i2cCursor = i2cWindow;
+      i2cChannel = 0;
+      break;
+    case I2C_REG_WINDOW_HIGH:
+      i2cWindow = (i2cWindow & 0x00FF) | ((uint16_t)value << 8);
+      i2cCursor = i2cWindow;
+      i2cChannel = 0;
+      break;
+    case I2C_REG_PIXELS:
+      if (i2cCursor < strip->numberOfPixels)
+      {
+        if (strip->brightness)
+          value = scale8(value, strip->brightness - 1);
+        pixel = i2cCursor;
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_HALF
+        pixel >>= 1;  // Neighbouring pixels share a color.
+#endif
+        strip->pixels[(pixel << 1) + pixel + i2cChannelOffset[i2cChannel]] = value;
+      }
+      if (++i2cChannel == 3)
+      {
+        i2cChannel = 0;
+        i2cCursor++;
+      }
+      return false;  // Burst: stay on I2C_REG_PIXELS.
+    case I2C_REG_SHOW:
+      i2cShowPending = true;
+      wake = true;
+      break;
+  }
+  i2cRegister++;
+  return wake;
+}
+
+
+// Next byte for the host to read.
+static uint8_t i2cTransmit(void)
+{
+  uint8_t value = 0;
+
+  switch (i2cRegister)
+  {
+    case I2C_REG_PATTERN:
+      value = (uint8_t)patternState;
+      break;
+    case I2C_REG_BRIGHTNESS:
+      value = i2cStrip->brightness - 1;
+      break;
+    case I2C_REG_WINDOW_LOW:
+      value = (uint8_t)i2cWindow;
+      break;
+    case I2C_REG_WINDOW_HIGH:
+      value = (uint8_t)(i2cWindow >> 8);
+      break;
+    case I2C_REG_PIXELS:
+      return 0;  // Write only, and stays put like a write burst.
+    case I2C_REG_SHOW:
+      value = i2cShowPending;
+      break;
+    case I2C_REG_COUNT_LOW:
+      value = (uint8_t)i2cStrip->numberOfPixels;
+      break;
+    case I2C_REG_COUNT_HIGH:
+      value = (uint8_t)(i2cStrip->numberOfPixels >> 8);
+      break;
+    case I2C_REG_RAM_STATIC_LOW:
+      ramCheck(&ramUsage);  // ~2 cycles a free byte, the bus stretches.
+      value = (uint8_t)ramUsage.staticBytes;
+      break;
+    case I2C_REG_RAM_STATIC_HIGH:
+      value = (uint8_t)(ramUsage.staticBytes >> 8);
+      break;
+    case I2C_REG_RAM_PEAK_LOW:
+      value = (uint8_t)ramUsage.stackPeak;
+      break;
+    case I2C_REG_RAM_PEAK_HIGH:
+      value = (uint8_t)(ramUsage.stackPeak >> 8);
+      break;
+    case I2C_REG_RAM_HEADROOM_LOW:
+      value = (uint8_t)ramUsage.headroom;
+      break;
+    case I2C_REG_RAM_HEADROOM_HIGH:
+      value = (uint8_t)(ramUsage.headroom >> 8);
+      break;
+  }
+  i2cRegister++;
+  return value;
+}
+
+
+// USCI_A0/B0 receive ISR.  In I2C mode this is USCI_B0's START and STOP,
+// the data bytes are on USCIAB0TX.  The next byte is a register, unless a
+// byte from before the condition is waiting (see START AND STOP above.)
+#pragma vector=USCIAB0RX_VECTOR
+__interrupt void USCIAB0RX_ISR(void)
+{
+  uint8_t condition = UCB0STAT & (UCSTPIFG | UCSTTIFG);
+
+  UCB0STAT &= ~condition;
+  if ((IFG2 & UCB0RXIFG)
+      && (((IE2 & UCB0RXIE) == 0) || i2cEndAfterByte || (condition == UCSTPIFG)))
+    i2cEndAfterByte = true;
+  else
+    i2cRegisterNext = true;
+}
+
+
+// USCI_A0/B0 transmit ISR.  In I2C mode this is every USCI_B0 data byte,
+// both directions.
+#pragma vector=USCIAB0TX_VECTOR
+__interrupt void USCIAB0TX_ISR(void)
+{
+  bool wake = false;
+
+  if ((IE2 & UCB0RXIE) && (IFG2 & UCB0RXIFG))
+    wake = i2cReceive();
+  else if (IFG2 & UCB0TXIFG)
+    UCB0TXBUF = i2cTransmit();
+
+  if (wake)
+    __bic_SR_register_on_exit(LPM0_bits);
+}
@@ -0,0 +1,51 @@
+/*
+ * i2c.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ */
+
+#ifndef I2C_H_
+#define I2C_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "WS2812B_Strip.h"
+
+// USCI_B0 as an I2C target: P3.1 SDA, P3.2 SCL (pull-ups on the host side.)
+#define I2C_PORT_SEL  P3SEL
+#define I2C_SDA_PIN   BIT1
+#define I2C_SCL_PIN   BIT2
+
+#define I2C_ADDRESS   0x28   // 7-bit
+
+// Register map.  A write is [register] [data...]; each data byte (or read)
+// moves on to the next register, except I2C_REG_PIXELS, which stays put so
+// a whole burst of pixels can follow.  So [WINDOW_LOW] [lo] [hi] [r g b...]
+// uploads a run of pixels in one transaction.
+#define I2C_REG_PATTERN      0x00  // R/W  enum pattern (patternHost to upload)
+#define I2C_REG_BRIGHTNESS   0x01  // R/W  0 - 255, setBrightness() from the
+                                   //      main loop (i2cPoll()).  Reads the
+                                   //      old value until then.
+#define I2C_REG_WINDOW_LOW   0x02  // R/W  First pixel the next I2C_REG_PIXELS
+#define I2C_REG_WINDOW_HIGH  0x03  //      byte goes to.
+#define I2C_REG_PIXELS       0x04  // W    R, G, B, R, G, B... from the window
+#define I2C_REG_SHOW         0x05  // R/W  Write anything: show() the upload.
+                                   //      Reads 1 until it has been shown.
+#define I2C_REG_COUNT_LOW    0x06  // R    NUMBER_OF_PIXELS
+#define I2C_REG_COUNT_HIGH   0x07
+#define I2C_REG_RAM_STATIC_LOW    0x08  // R  ramUsage (ramcheck.h), bytes.
+#define I2C_REG_RAM_STATIC_HIGH   0x09  //    Reading STATIC_LOW runs
+#define I2C_REG_RAM_PEAK_LOW      0x0A  //    ramCheck() first, so read all
+#define I2C_REG_RAM_PEAK_HIGH     0x0B  //    six from there for a fresh
+#define I2C_REG_RAM_HEADROOM_LOW  0x0C  //    set.
+#define I2C_REG_RAM_HEADROOM_HIGH 0x0D
+
+void i2cInit(struct WS2812B_Strip *strip);
+void i2cStop(void);
+void i2cPoll(struct WS2812B_Strip *strip);
+
+// PATTERNS
+void hostPixels(struct WS2812B_Strip *strip);
+
+#endif /* I2C_H_ */
@@ -0,0 +1,336 @@
+/*
+ * ir.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * NEC IR remote: number keys pick a pattern, next/prev step through them,
+ * volume up/down change the brightness (and keep going while held.)
+ *
+ * CAPTURE:
+ *   Timer_A is the audio sample clock, so the receiver goes on a Timer_B
+ *   capture input instead; Timer_B is the free running timebase anyway.
+ *   CCR1 latches TBR on every edge in hardware, so even while show() has
+ *   interrupts off the first edge keeps its exact time.  A second edge in
+ *   that window sets COV and the first is lost; the ISR then queues
+ *   IR_EDGE_LOST, the decoder drops that frame and waits for the next
+ *   leader.  Nothing is decoded in the ISR, it only queues the interval
+ *   since the last edge and wakes the CPU.
+ *
+ *   The last edge is kept as a 32-bit timebase tick, so long idle gaps
+ *   saturate instead of wrapping every 32.768ms into something that can
+ *   look like a leader mark.
+ *
+ * SHOW():
+ *   show() has interrupts off for ~1ms every frame, and a frame's edges
+ *   are 562us apart, so a fast pattern would lose nearly every frame to
+ *   COV.  Once a leader has been seen, show() calls irWait() first, which
+ *   holds it off until the frame is decoded or IR_FRAME_TIMEOUT_MS passes
+ *   without an edge.  The leader mark itself is long enough for a show().
+ *
+ * DECODING:
+ *   irPoll() runs from main context (frameWait(), delay_ms() and
+ *   audioPulse()) and feeds the queue through irDecode(), one interval at
+ *   a time.  A frame is: 9ms mark, 4.5ms space, then 32 bits of 562us mark
+ *   + 562us (0) or 1687us (1) space, LSB first: address, ~address or the
+ *   high address byte, command, ~command.  Only the command is checked.
+ *
+ *   irDecode() touches no registers, so it can be fed recorded traces off
+ *   target.
+ */
+
+#include <msp430f2272.h>
+#include "ir.h"
+#include "main.h"
+#include "colormath.h"
+#include "scheduler.h"
+
+// Edge intervals from the ISR.  irHead is only written by the ISR,
+// irTail only by irPoll().
+static volatile uint8_t irQueue[IR_QUEUE_SIZE];
+static volatile uint8_t irHead, irTail;
+static uint32_t irLastEdge;
+
+volatile uint16_t irFramesLost;
+
+// Number keys 0 - 9 on the same remote, in order.
+static const uint8_t irDigitKeys[10] = {
+  0x16, 0x0C, 0x18, 0x5E, 0x08, 0x1C, 0x5A, 0x42, 0x52, 0x4A
+};
+
+enum irState {
+  irIdle,       // Waiting for a leader mark.
+  irLeader,     // Leader mark seen, new frame or repeat?
+  irMark,       // Expecting a bit's mark.
+  irSpace,      // Expecting a bit's space, which is the bit.
+  irRepeatMark  // Repeat code's closing mark.
+};
+
+static enum irState irDecoderState;
+static uint32_t irBits;
+static uint8_t irBitCount;
+static uint8_t irLastCommand;
+static bool irLastValid;
+
+static void irCommand(struct WS2812B_Strip *strip, uint8_t command, bool repeat);
+
+
+// Start capturing both edges on IR_PIN.  Needs timebaseInit() first.
+void irInit(void)
+{
+  irHead = 0;
+  irTail = 0;
+  irDecoderState = irIdle;
+  irLastEdge = timebaseNow();
+  IR_PORT_DIR &= ~IR_PIN;
+  IR_PORT_SEL |= IR_PIN;
+  TBCCTL1 = CM_3 | CCIS_0 | SCS | CAP | CCIE;
+}
+
+
+// Stop capturing, so IR no longer wakes the CPU.
+void irStop(void)
+{
+  TBCCTL1 = 0;
+  IR_PORT_SEL &= ~IR_PIN;
+}
+
+
+// Timer_B CCR1 capture, called from the Timer_B1 ISR (which wakes the CPU.)
+// Queue the time since the last edge.
+void irCapture(void)
+{
+  // The capture is at most one overflow old, extend it to 32 bits.
+  uint32_t now = timebaseNow();
+  uint32_t edge = now - (uint16_t)((uint16_t)now - TBCCR1);
+  uint32_t interval = (edge - irLastEdge) >> IR_INTERVAL_SHIFT;
+  uint8_t next = (irHead + 1) & (IR_QUEUE_SIZE - 1);
+
+  irLastEdge = edge;
+  if (TBCCTL1 & COV)
+  {
+    TBCCTL1 &= ~COV;
+    interval = IR_EDGE_LOST;
+  }
+  else if (interval > 255)
+  {
+    interval = 255;
+  }
+  else if (interval == IR_EDGE_LOST)
+  {
+    interval = 1;  // Glitch, too short for anything anyway.
+  }
+
+  if (next == irTail)
+  {
+    // Full: the newest interval becomes a lost marker instead.
+    irQueue[(irHead - 1) & (IR_QUEUE_SIZE - 1)] = IR_EDGE_LOST;
+    return;
+  }
+  irQueue[irHead] = (uint8_t)interval;
+  irHead = next;
+}
+
+
+// Decode everything queued so far and act on any complete command.
+void irPoll(struct WS2812B_Strip *strip)
+{
+  uint8_t command;
+
+  while (irTail != irHead)
+  {
+    uint8_t interval = irQueue[irTail];
+    irTail = (irTail + 1) & (IR_QUEUE_SIZE - 1);
+
+    switch (irDecode(interval, &command))
+    {
+      case IR_KEY_PRESSED:
+        irCommand(strip, command, false);
+        break;
+      case IR_KEY_HELD:
+        irCommand(strip, command, true);
+        break;
+    }
+  }
+}
+
+
+// True while a frame is being received, false once the decoder is idle or
+// the frame has gone IR_FRAME_TIMEOUT_MS without an edge (it is dropped.)
+// Call irPoll() first.
+bool irReceiving(void)
+{
+  uint32_t lastEdge;
+
+  if (irDecoderState == irIdle)
+    return false;
+
+  __bic_SR_register(GIE);
+  lastEdge = irLastEdge;
+  __bis_SR_register(GIE);
+
+  if ((timebaseNow() - lastEdge) < (uint32_t)IR_FRAME_TIMEOUT_MS * TIMEBASE_TICKS_PER_MS)
+    return true;
+  irDecoderState = irIdle;
+  irFramesLost++;
+  return false;
+}
+
+
+// Sleep while a frame is being received, so show() doesn't cost it edges.
+// Interrupts must be on.  A key that breaks the pattern ends the wait.
+void irWait(struct WS2812B_Strip *strip)
+{
+  uint32_t lastEdge;
+
+  irPoll(strip);
+  while ((strip->breakFromPattern == false) && irReceiving())
+  {
+    __bic_SR_register(GIE);
+    lastEdge = irLastEdge;
+    __bis_SR_register(GIE);
+    timebaseSleepUntil(lastEdge + (uint32_t)IR_FRAME_TIMEOUT_MS * TIMEBASE_TICKS_PER_MS);
+    irPoll(strip);
+  }
+}
+
+
+// Feed one edge interval to the NEC decoder.  Returns IR_KEY_PRESSED or
+// IR_KEY_HELD (repeat code) with the command byte when a frame has just
+// finished, IR_KEY_NONE otherwise.
+//
+// PSUEDO:
+//  1. Lost edges: drop the frame.
+//  2. Leader mark, then its space says new frame or repeat.
+//  3. 32 mark/space pairs, the space length is the bit.
+//  4. Command and its inverse must agree.
+uint8_t irDecode(uint8_t interval, uint8_t *command)
+{
+  //  1. Lost edges: drop the frame.
+  if (interval == IR_EDGE_LOST)
+  {
+    if (irDecoderState != irIdle)
+      irFramesLost++;
+    irDecoderState = irIdle;
+    irLastValid = false;  // A repeat may be for some other key now.
+    return IR_KEY_NONE;
+  }
+
+  switch (irDecoderState)
+  {
+    //  2. Leader mark, then its space says new frame or repeat.
+    case irIdle:
+      if ((interval >= IR_NEC_LEADER_MIN) && (interval <= IR_NEC_LEADER_MAX))
+        irDecoderState = irLeader;
+      return IR_KEY_NONE;
+
+    case irLeader:
+      if ((interval >= IR_NEC_SPACE_MIN) && (interval <= IR_NEC_SPACE_MAX))
+      {
+        irBits = 0;
+        irBitCount = 0;
+        irDecoderState = irMark;
+      }
+      else if ((interval >= IR_NEC_REPEAT_MIN) && (interval <= IR_NEC_REPEAT_MAX))
+      {
+        irDecoderState = irRepeatMark;
+      }
+      else if ((interval < IR_NEC_LEADER_MIN) || (interval > IR_NEC_LEADER_MAX))
+      {
+        irDecoderState = irIdle;
+      }
+      // Else that was an idle gap that looked like a leader, and this is
+      // the real one: stay in irLeader.
+      return IR_KEY_NONE;
+
+    case irRepeatMark:
+      irDecoderState = irIdle;
+      if ((interval < IR_NEC_SHORT_MIN) || (interval > IR_NEC_SHORT_MAX) || (irLastValid == false))
+        return IR_KEY_NONE;
+      *command = irLastCommand;
+      return IR_KEY_HELD;
+
+    //  3. 32 mark/space pairs, the space length is the bit.
+    case irMark:
+      if ((interval < IR_NEC_SHORT_MIN) || (interval > IR_NEC_SHORT_MAX))
+      {
+        irDecoderState = irIdle;
+        return IR_KEY_NONE;
+      }
+      if (irBitCount == 32)
+        break;  // Closing mark, frame done.
+      irDecoderState = irSpace;
+      return IR_KEY_NONE;
+
+    case irSpace:
+      irBits >>= 1;
+      if ((interval >= IR_NEC_LONG_MIN) && (interval <= IR_NEC_LONG_MAX))
+        irBits |= 0x80000000;
+      else if ((interval < IR_NEC_SHORT_MIN) || (interval > IR_NEC_SHORT_MAX))
+      {
+        irDecoderState = irIdle;
+        return IR_KEY_NONE;
+      }
+      irBitCount++;
+      irDecoderState = irMark;
+      return IR_KEY_NONE;
+  }
+
+  //  4. Command and its inverse must agree.
+  irDecoderState = irIdle;
+  if ((uint8_t)(irBits >> 16) != (uint8_t)~(irBits >> 24))
+  {
+    irLastValid = false;
+    return IR_KEY_NONE;
+  }
+  irLastCommand = (uint8_t)(irBits >> 16);
+  irLastValid = true;
+  *command = irLastCommand;
+  return IR_KEY_PRESSED;
+}
+
+
+// Act on a key.  Held keys (repeat codes) only repeat the brightness keys.
+static void irCommand(struct WS2812B_Strip *strip, uint8_t command, bool repeat)
+{
+  uint8_t digit;
+  uint8_t brightness = strip->brightness - 1;  // See setBrightness().
+
+  switch (command)
+  {
+    case IR_KEY_VOL_UP:
+      setBrightness(strip, qadd8(brightness, IR_BRIGHTNESS_STEP));
+      return;
+    case IR_KEY_VOL_DOWN:
+      brightness = qsub8(brightness, IR_BRIGHTNESS_STEP);
+      setBrightness(strip, (brightness == 0) ? 1 : brightness);  // Not off.
+      return;
+  }
+  if (repeat)
+    return;
+
+  switch (command)
+  {
+    case IR_KEY_NEXT:
+      if (++patternState >= NUMBER_OF_PATTERNS)
+        patternState = patternRGB;
+      break;
+    case IR_KEY_PREV:
+      if (patternState == patternRGB)
+        patternState = (enum pattern)(NUMBER_OF_PATTERNS - 1);
+      else
+        patternState--;
+      break;
+    default:
+      for (digit = 0; digit < 10; digit++)
+      {
+        if (irDigitKeys[digit] == command)
+          break;
+      }
+      if ((digit == 10) || (digit >= NUMBER_OF_PATTERNS))
+        return;
+      patternState = (enum pattern)digit;
+      break;
+  }
+  strip->breakFromPattern = true;
+}
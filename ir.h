@@ -0,0 +1,65 @@
+/*
+ * ir.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ */
+
+#ifndef IR_H_
+#define IR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "WS2812B_Strip.h"
+
+// IR receiver (TSOP style, active low) on P4.1/TB1, Timer_B CCR1 capture.
+#define IR_PORT_SEL  P4SEL
+#define IR_PORT_DIR  P4DIR
+#define IR_PIN       BIT1
+
+// Edge to edge intervals are queued in units of 128 timebase ticks (64us),
+// saturated at 255.  0 marks edges lost while interrupts were off.
+#define IR_INTERVAL_SHIFT   7
+#define IR_EDGE_LOST        0
+#define IR_QUEUE_SIZE       32   // Power of 2.
+
+// No edge for this long (the longest NEC interval is the 9ms leader) and
+// the frame being received is given up on, see irWait().
+#define IR_FRAME_TIMEOUT_MS 12
+
+// NEC timings in 64us units, with some slack for cheap receivers.
+#define IR_NEC_LEADER_MIN   120  // 9ms mark
+#define IR_NEC_LEADER_MAX   160
+#define IR_NEC_SPACE_MIN    60   // 4.5ms space, then 32 data bits
+#define IR_NEC_SPACE_MAX    80
+#define IR_NEC_REPEAT_MIN   28   // 2.25ms space, key still held
+#define IR_NEC_REPEAT_MAX   42
+#define IR_NEC_SHORT_MIN    5    // 562us, every mark and a 0 space
+#define IR_NEC_SHORT_MAX    14
+#define IR_NEC_LONG_MIN     20   // 1687us, a 1 space
+#define IR_NEC_LONG_MAX     32
+
+// Command bytes of the common 21 key NEC remote.
+#define IR_KEY_PREV         0x44
+#define IR_KEY_NEXT         0x40
+#define IR_KEY_VOL_DOWN     0x07
+#define IR_KEY_VOL_UP       0x15
+#define IR_BRIGHTNESS_STEP  16
+
+// irDecode() results.
+#define IR_KEY_NONE         0
+#define IR_KEY_PRESSED      1
+#define IR_KEY_HELD         2   // Repeat code, same key as last time.
+
+// Frames dropped because edges were lost, for the debugger.
+extern volatile uint16_t irFramesLost;
+
+void irInit(void);
+void irStop(void);
+void irCapture(void);
+void irPoll(struct WS2812B_Strip *strip);
+bool irReceiving(void);
+void irWait(struct WS2812B_Strip *strip);
+uint8_t irDecode(uint8_t interval, uint8_t *command);
+
+#endif /* IR_H_ */
@@ -86,10 +86,13 @@ MEMORY
 
 SECTIONS
 {
-    .bss        : {} > RAM                  /* Global & static vars              */
-    .data       : {} > RAM                  /* Global & static vars              */
-    .TI.noinit  : {} > RAM                  /* For #pragma noinit                */
-    .sysmem     : {} > RAM                  /* Dynamic memory allocation area    */
+    GROUP                                   /* Statics at the bottom of RAM, end */
+    {                                       /* marked for ramcheck.c             */
+        .bss                                /* Global & static vars              */
+        .data                               /* Global & static vars              */
+        .TI.noinit                          /* For #pragma noinit                */
+        .sysmem                             /* Dynamic memory allocation area    */
+    } > RAM, RUN_END(__RAM_STATIC_END)
     .stack      : {} > RAM (HIGH)           /* Software system stack             */
 
     .text       : {} > FLASH                /* Code                              */
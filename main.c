@@ -14,13 +14,18 @@
  *                MSP430F2272
  *             -----------------
  *         /|\|              XIN|-
- *          | |                 |
+ *          | |                 | 32768Hz crystal (DCO_CRYSTAL, optional)
  *          --|RST          XOUT|-
  *            |                 |
  *            |             P1.0|--> switch to change pattern UP   (active LOW)
  *            |             p1.1|--> switch to change pattern DOWN (active LOW)
  *            |             P4.4|--> Status LED.
  *            |             P4.5|--> SERIAL DATA for RGB LED control
+ *            |          P2.0/A0|<-- Microphone (audioPulse)
+ *            |             P2.1|<-> Frame sync line to other boards
+ *            |         P4.1/TB1|<-- IR receiver (NEC remote)
+ *            |     P3.1/UCB0SDA|<-> I2C from a host processor (target 0x28)
+ *            |     P3.2/UCB0SCL|<--
  *            |                 |
  *                     .
  *                     .
@@ -43,6 +48,15 @@
 #include <msp430f2272.h>
 #include "main.h"
 #include "patterns.h"
+#include "effects.h"
+#include "audio.h"
+#include "scheduler.h"
+#include "sync.h"
+#include "matrix.h"
+#include "ir.h"
+#include "ramcheck.h"
+#include "dco.h"
+#include "i2c.h"
 #include "WS2812B_Strip.h"
 
 struct WS2812B_Strip strip;
@@ -54,6 +68,10 @@ enum pattern patternState = NUMBER_OF_PATTERNS;
 // 1.3 - Interrupt setup for "PATTERN STATE CHANGE SWITCH" PORTx, PINx.
 // 1.4 - Set outputs for the Status LED pin and the Serial TX pin.
 // 1.5 - Initialize all pixels to 'off'
+// 1.6 - Start the free running timebase.
+// 1.7 - Frame sync line to the other boards.
+// 1.8 - IR remote receiver and I2C target.
+// 1.9 - Paint free RAM for the stack high water mark.
 // 2.0 - Shutdown CPU, enable global interrupts.
 // 3.0 - Main loop.
 int main(void)
@@ -62,6 +80,7 @@ int main(void)
   WDTCTL = WDTPW | WDTHOLD;	  // Stop watchdog timer
   DCOCTL |= CALDCO_16MHZ;     // Set DCO CLK 16MHz
   BCSCTL1 |= CALBC1_16MHZ;
+  dcoCalibrate();             // Trim onto the watch crystal, if fitted (see dco.c.)
 
 
   // 1.2 - PORT RESETS (For low power consumption)
@@ -103,6 +122,20 @@ int main(void)
   show(&strip);
   setBrightness(&strip, 64);  // 64/255 ~= 25% intensity.
 
+  // 1.6 - Start the free running timebase used by delay_ms() and frameWait().
+  timebaseInit();
+
+  // 1.7 - Frame sync line to the other boards (SYNC_ROLE.)
+  syncInit();
+
+  // 1.8 - IR remote receiver, captured on the timebase (see ir.c.)
+  //       I2C target for a host processor (see i2c.c.)
+  irInit();
+  i2cInit(&strip);
+
+  // 1.9 - Paint free RAM for the stack high water mark (see ramcheck.c.)
+  ramPaint();
+
   // 2.0 - Shutdown CPU, enable global interrupts.
   __bis_SR_register(LPM0_bits | GIE);
 
@@ -168,6 +201,36 @@ int main(void)
 
       strip.breakFromPattern = false;
     }
+    while (patternState == patternFire)
+    {
+      fire(&strip, 55, 120, 15);
+      strip.breakFromPattern = false;
+    }
+    while (patternState == patternMeteorRain)
+    {
+      meteorRain(&strip, color(0xFF, 0xFF, 0xFF), 0x1F, 30);
+      strip.breakFromPattern = false;
+    }
+    while (patternState == patternSparkle)
+    {
+      sparkle(&strip, color(0xFF, 0xFF, 0xFF), 80, 20);
+      strip.breakFromPattern = false;
+    }
+    while (patternState == patternAudioPulse)
+    {
+      audioPulse(&strip);
+      strip.breakFromPattern = false;
+    }
+    while (patternState == patternMatrixZones)
+    {
+      matrixZones(&strip, 20);
+      strip.breakFromPattern = false;
+    }
+    while (patternState == patternHost)
+    {
+      hostPixels(&strip);
+      strip.breakFromPattern = false;
+    }
     if (patternState == NUMBER_OF_PATTERNS)
       patternState = patternRGB;
 
@@ -217,9 +280,7 @@ __interrupt void Port_1(void)
     // 1.0 Blank the output LED Strip.
     strip.inInterrupt = true;
     strip.breakFromPattern  = true;
-	strip.inShow = false;
-    clear(&strip);
-    show(&strip);
+    blank(&strip);
 
 	// 2.0 Start our button hold count
 	volatile uint32_t buttonHold_ms = 0;
@@ -239,7 +300,13 @@ __interrupt void Port_1(void)
 
     	strip.inInterrupt = false;
    		PSC_SW_PORT_IFG &=  ~PSC_SW_PIN;
+   		TBCCTL0 = 0;   // Only the button may wake us, not a frame deadline
+   		audioStop();   // or the ADC10
+   		irStop();      // or the IR remote
+   		i2cStop();     // or the host.
    		__bis_SR_register(LPM0_bits | GIE);  // Turn off the CPU, enable global interrupts.
+   		irInit();
+   		i2cInit(&strip);
     	return;
       }
     }
@@ -247,9 +314,11 @@ __interrupt void Port_1(void)
     // 4.1 - Pattern change if button hold < 1000ms.
     if (buttonHold_ms < 1000)
     {
-      // 4.1.1 - Flash for status change.
+      // 4.1.1 - Flash for status change, three times as long if the stack
+      //        has come within RAM_LOW_WARNING bytes of the statics.
       volatile uint8_t i;  // i NEEDS to be an even number!
-      for (i = 10; i != 0; i--)
+      ramCheck(&ramUsage);
+      for (i = (ramUsage.headroom < RAM_LOW_WARNING) ? 30 : 10; i != 0; i--)
       {
         STATUS_LED_PORT ^= STATUS_LED_PIN;
         __delay_cycles(1600000); // 100ms.
@@ -290,6 +359,50 @@ __interrupt void Port_1(void)
 
 
 
+// Port 2 interrupt service routine
+// Used to:
+//  A. Follow the master board's frames (SYNC_ROLE == SYNC_FOLLOWER.)
+//
+//  Psuedo:
+// 1.0 - Read the sync packet (and when it ended) before anything else.
+// 2.0 - Switch to the master's pattern, waking the CPU to start it.
+// 3.0 - Take the master's brightness and hand the step to frameWait().
+// 4.0 - Clear our PORT interrupt flag.
+#pragma vector=PORT2_VECTOR
+__interrupt void Port_2(void)
+{
+  static struct SyncPacket packet;
+  uint16_t endTick;
+  uint32_t now;
+
+  // 1.0 - Read the sync packet (and when it ended) before anything else,
+  //       we are already inside the start bit.
+  if ((SYNC_PORT_IFG & SYNC_PIN) && (syncReceive(&packet, &endTick) == true))
+  {
+    now = timebaseNow();
+
+    // 2.0 - Switch to the master's pattern, waking the CPU to start it.
+    if ((packet.pattern != patternState) && (packet.pattern < NUMBER_OF_PATTERNS))
+    {
+      patternState = (enum pattern)packet.pattern;
+      strip.breakFromPattern = true;
+      __bic_SR_register_on_exit(LPM0_bits);
+    }
+
+    // 3.0 - Take the master's brightness and hand the step to frameWait().
+    strip.brightness = packet.brightness;
+    strip.frame.syncTime = now + (int16_t)(endTick - (uint16_t)now);  // Either side of now.
+    strip.frame.syncStep = packet.step;
+    strip.frame.syncPending = true;
+    __bic_SR_register_on_exit(LPM0_bits);
+  }
+
+  // 4.0 - Clear our PORT interrupt flag.
+  SYNC_PORT_IFG &= ~SYNC_PIN;
+}
+
+
+
 void blinkStatusLED(const uint32_t blinkDelay, const uint8_t blinkCount)
 {
   uint8_t i = 2 * blinkCount; // Make sure we have an even on/off ratio.
@@ -301,33 +414,22 @@ void blinkStatusLED(const uint32_t blinkDelay, const uint8_t blinkCount)
   }
 }
 
-// TimerA ISR. Used for delay
-#pragma vector=TIMER0_A0_VECTOR
-__interrupt void Timer_A (void)
-{
-  // wake on CCR0 count match
-  TA0CCTL0 = 0;
-  //__enable_interrupt();
-  //__bic_SR_register_on_exit(LPM0_bits);
-}
-
+// Busy wait on the free running timebase (see scheduler.c.)  Gives up as
+// soon as the pattern has to stop, so the next one (e.g. hostPixels()
+// holding the I2C bus) isn't kept waiting for the rest of the delay.
 void delay_ms(uint32_t delayTime)
 {
+  delayUntil(timebaseNow() + delayTime * TIMEBASE_TICKS_PER_MS);
+}
 
 
-  // change according to your SMCLK frequency
-  TA0CCR0 = 16000;
-  TA0CTL = TASSEL_2 + MC_2;  // Use SMCLK + continous up
-  while ((delayTime != 0) && (strip.inInterrupt == false))
+// As delay_ms(), to an absolute timebase tick.
+void delayUntil(uint32_t tick)
+{
+  while ((strip.inInterrupt == false) && (strip.breakFromPattern == false)
+         && (timebaseSleepUntil(tick) == false))
   {
-    TA0R = 0;                // Counter Register.
-    TA0CCTL0 = CCIE;         // Enable Capture/control.
-    while(TA0R < 16000)
-    {
-      //__bis_SR_register(LPM0_bits | GIE);
-      __no_operation();
-    }
-    delayTime--;
+    irPoll(&strip);
+    i2cPoll(&strip);
   }
-  TA0CTL = 0;
 }
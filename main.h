@@ -34,9 +34,49 @@
 
 
 // Number of pixels cannot excede the available RAM on your device.  It takes 3 bytes of RAM per pixel
-// This code uses XXX RAM to run the software and you NEED to account for that
-// I.E., 1kiB RAM means you cannot have more than ~430 pixels on your strip.
+// (more with a front buffer, see FRAMEBUFFER_MODE below) and effects.c keeps one more per pixel.
+#ifndef NUMBER_OF_PIXELS
 #define NUMBER_OF_PIXELS 38  // 38 Pixels on the Hat!!!
+#endif
+
+// Frame buffer layout, pick one for FRAMEBUFFER_MODE:
+//  SINGLE: show() transmits the buffer patterns draw into.  3 bytes/pixel.
+//  DOUBLE: patterns draw into a back buffer, show() swaps it to the front
+//          and transmits that.  Tear free, ISRs never see half a frame.
+//          6 bytes/pixel.
+//  HALF:   as DOUBLE but the back buffer is half resolution (pixel pairs
+//          share a color.)  4.5 bytes/pixel.
+#define FRAMEBUFFER_SINGLE 0
+#define FRAMEBUFFER_DOUBLE 1
+#define FRAMEBUFFER_HALF   2
+#ifndef FRAMEBUFFER_MODE
+#define FRAMEBUFFER_MODE   FRAMEBUFFER_SINGLE
+#endif
+
+// What the rest of the software takes from the 1kiB: ~350 bytes of statics
+// besides the pixel buffers (the .bss/.data/.sysmem GROUP up to
+// __RAM_STATIC_END in the .map, less strip's buffers and effectBuffer) and
+// the heap and stack sizes from the project's linker options.  ramUsage in
+// ramcheck.c has the real numbers at run time.
+// That leaves room for ~128 pixels in SINGLE, ~93 in HALF or ~73 in DOUBLE.
+#define RAM_SIZE          1024
+#define RAM_STATIC_BYTES  350
+#define RAM_HEAP_BYTES    80
+#define RAM_STACK_BYTES   80   // Why pattern and ISR state bigger than a few bytes is static.
+
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_SINGLE
+#define RAM_PIXEL_BYTES   (3 * NUMBER_OF_PIXELS)
+#elif FRAMEBUFFER_MODE == FRAMEBUFFER_DOUBLE
+#define RAM_PIXEL_BYTES   (6 * NUMBER_OF_PIXELS)
+#elif FRAMEBUFFER_MODE == FRAMEBUFFER_HALF
+#define RAM_PIXEL_BYTES   (3 * NUMBER_OF_PIXELS + 3 * ((NUMBER_OF_PIXELS + 1) / 2))
+#else
+#error "FRAMEBUFFER_MODE must be FRAMEBUFFER_SINGLE, FRAMEBUFFER_DOUBLE or FRAMEBUFFER_HALF"
+#endif
+
+#if RAM_PIXEL_BYTES + NUMBER_OF_PIXELS + RAM_STATIC_BYTES + RAM_HEAP_BYTES + RAM_STACK_BYTES > RAM_SIZE
+#error "NUMBER_OF_PIXELS doesn't fit in RAM with this FRAMEBUFFER_MODE, use fewer or a smaller FRAMEBUFFER_MODE"
+#endif
 
 enum pattern {
 	patternRGB,
@@ -47,12 +87,21 @@ enum pattern {
 	patternTheaterChase,
 	patternTheaterChaseRainbow,
 	patternBreathe,
+	patternFire,
+	patternMeteorRain,
+	patternSparkle,
+	patternAudioPulse,
+	patternMatrixZones,
+	patternHost,
 	NUMBER_OF_PATTERNS
 };
 
+extern enum pattern patternState;
+
 inline void ISR_Sleep();
 
 void blinkStatusLED(const uint32_t blinkRate, const uint8_t blinkCount);
 void delay_ms(uint32_t delayTime);
+void delayUntil(uint32_t tick);
 
 #endif // MAIN_H_
@@ -0,0 +1,280 @@
+/*
+ * matrix.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * 2D matrix and zone addressing on top of setPixelColor().
+ *
+ * matrixIndex(x, y) turns a picture coordinate into a strip index through
+ * two tables in flash: matrixRowStart[] (y * width) and matrixTable[] (the
+ * wiring, serpentine and rotation all folded in.)  So a 2D pattern pays two
+ * table reads per pixel and no multiply.
+ *
+ * The tables are built by the preprocessor from MATRIX_WIDTH, _HEIGHT,
+ * _LAYOUT and _ROTATION, so changing the panel is just changing matrix.h.
+ * MATRIX_CELLS_n(f, i) expands to f(i), f(i + 1) ... f(i + n - 1), and each
+ * table is a run of those, one for every bit set in its size.  All the
+ * arithmetic in MATRIX_CELL() is on constants, none of it is run time.
+ *
+ * Zones split the one data line into runs of pixels.  Each runs its own
+ * instance of a zone pattern, a function that draws one frame of one zone
+ * from its ZoneInstance, and matrixZones() draws them all into the same
+ * frame.  host/test_matrix.c checks the mapping on the wire for both
+ * layouts and every rotation, and that zones don't draw on each other.
+ */
+
+#include "matrix.h"
+#include "colormath.h"
+#include "patterns.h"
+
+#if MATRIX_PIXELS > 511
+#error "MATRIX_PIXELS must be 511 or less"
+#endif
+#if MATRIX_LOGICAL_HEIGHT > 31
+#error "MATRIX_LOGICAL_HEIGHT must be 31 or less"
+#endif
+#if MATRIX_FIRST_PIXEL + MATRIX_PIXELS > NUMBER_OF_PIXELS
+#error "The matrix does not fit in NUMBER_OF_PIXELS"
+#endif
+
+// Picture coordinates of logical cell i (row major.)
+#define MATRIX_X(i)  ((i) % MATRIX_LOGICAL_WIDTH)
+#define MATRIX_Y(i)  ((i) / MATRIX_LOGICAL_WIDTH)
+
+// Picture (x, y) to the physical column and row as wired.
+#if MATRIX_ROTATION == 0
+#define MATRIX_COLUMN(x, y)  (x)
+#define MATRIX_ROW(x, y)     (y)
+#elif MATRIX_ROTATION == 1
+#define MATRIX_COLUMN(x, y)  (MATRIX_WIDTH - 1 - (y))
+#define MATRIX_ROW(x, y)     (x)
+#elif MATRIX_ROTATION == 2
+#define MATRIX_COLUMN(x, y)  (MATRIX_WIDTH - 1 - (x))
+#define MATRIX_ROW(x, y)     (MATRIX_HEIGHT - 1 - (y))
+#else
+#define MATRIX_COLUMN(x, y)  (y)
+#define MATRIX_ROW(x, y)     (MATRIX_HEIGHT - 1 - (x))
+#endif
+
+// Physical column and row to strip index.  Odd serpentine rows run back.
+#define MATRIX_WIRED(column, row)                                              \
+  (MATRIX_FIRST_PIXEL + (row) * MATRIX_WIDTH                                   \
+   + (((MATRIX_LAYOUT == MATRIX_SERPENTINE) && ((row) & 1))                    \
+      ? (MATRIX_WIDTH - 1 - (column)) : (column)))
+
+#define MATRIX_CELL(i)       MATRIX_WIRED(MATRIX_COLUMN(MATRIX_X(i), MATRIX_Y(i)), \
+                                          MATRIX_ROW(MATRIX_X(i), MATRIX_Y(i)))
+#define MATRIX_ROW_START(y)  ((y) * MATRIX_LOGICAL_WIDTH)
+
+#define MATRIX_CELLS_1(f, i)    f(i),
+#define MATRIX_CELLS_2(f, i)    MATRIX_CELLS_1(f, i)   MATRIX_CELLS_1(f, (i) + 1)
+#define MATRIX_CELLS_4(f, i)    MATRIX_CELLS_2(f, i)   MATRIX_CELLS_2(f, (i) + 2)
+#define MATRIX_CELLS_8(f, i)    MATRIX_CELLS_4(f, i)   MATRIX_CELLS_4(f, (i) + 4)
+#define MATRIX_CELLS_16(f, i)   MATRIX_CELLS_8(f, i)   MATRIX_CELLS_8(f, (i) + 8)
+#define MATRIX_CELLS_32(f, i)   MATRIX_CELLS_16(f, i)  MATRIX_CELLS_16(f, (i) + 16)
+#define MATRIX_CELLS_64(f, i)   MATRIX_CELLS_32(f, i)  MATRIX_CELLS_32(f, (i) + 32)
+#define MATRIX_CELLS_128(f, i)  MATRIX_CELLS_64(f, i)  MATRIX_CELLS_64(f, (i) + 64)
+#define MATRIX_CELLS_256(f, i)  MATRIX_CELLS_128(f, i) MATRIX_CELLS_128(f, (i) + 128)
+
+// Strip index of every picture cell, row major.
+static const uint16_t matrixTable[MATRIX_PIXELS] = {
+#if MATRIX_PIXELS & 256
+  MATRIX_CELLS_256(MATRIX_CELL, 0)
+#endif
+#if MATRIX_PIXELS & 128
+  MATRIX_CELLS_128(MATRIX_CELL, MATRIX_PIXELS & 256)
+#endif
+#if MATRIX_PIXELS & 64
+  MATRIX_CELLS_64(MATRIX_CELL, MATRIX_PIXELS & 384)
+#endif
+#if MATRIX_PIXELS & 32
+  MATRIX_CELLS_32(MATRIX_CELL, MATRIX_PIXELS & 448)
+#endif
+#if MATRIX_PIXELS & 16
+  MATRIX_CELLS_16(MATRIX_CELL, MATRIX_PIXELS & 480)
+#endif
+#if MATRIX_PIXELS & 8
+  MATRIX_CELLS_8(MATRIX_CELL, MATRIX_PIXELS & 496)
+#endif
+#if MATRIX_PIXELS & 4
+  MATRIX_CELLS_4(MATRIX_CELL, MATRIX_PIXELS & 504)
+#endif
+#if MATRIX_PIXELS & 2
+  MATRIX_CELLS_2(MATRIX_CELL, MATRIX_PIXELS & 508)
+#endif
+#if MATRIX_PIXELS & 1
+  MATRIX_CELLS_1(MATRIX_CELL, MATRIX_PIXELS & 510)
+#endif
+};
+
+// Offset of each picture row in matrixTable[].
+static const uint16_t matrixRowStart[MATRIX_LOGICAL_HEIGHT] = {
+#if MATRIX_LOGICAL_HEIGHT & 16
+  MATRIX_CELLS_16(MATRIX_ROW_START, 0)
+#endif
+#if MATRIX_LOGICAL_HEIGHT & 8
+  MATRIX_CELLS_8(MATRIX_ROW_START, MATRIX_LOGICAL_HEIGHT & 16)
+#endif
+#if MATRIX_LOGICAL_HEIGHT & 4
+  MATRIX_CELLS_4(MATRIX_ROW_START, MATRIX_LOGICAL_HEIGHT & 24)
+#endif
+#if MATRIX_LOGICAL_HEIGHT & 2
+  MATRIX_CELLS_2(MATRIX_ROW_START, MATRIX_LOGICAL_HEIGHT & 28)
+#endif
+#if MATRIX_LOGICAL_HEIGHT & 1
+  MATRIX_CELLS_1(MATRIX_ROW_START, MATRIX_LOGICAL_HEIGHT & 30)
+#endif
+};
+
+const struct Zone zones[NUMBER_OF_ZONES] = {
+  { MATRIX_FIRST_PIXEL, MATRIX_PIXELS },                                      // ZONE_MATRIX
+  { MATRIX_FIRST_PIXEL + MATRIX_PIXELS,
+    NUMBER_OF_PIXELS - MATRIX_FIRST_PIXEL - MATRIX_PIXELS }                   // ZONE_TAIL
+};
+
+// Plasma on the matrix, a rainbow running the other way on the tail.
+struct ZoneInstance zoneInstances[NUMBER_OF_ZONES] = {
+  { zonePlasma,  0, 1,   0 },                                                 // ZONE_MATRIX
+  { zoneRainbow, 0, 255, 0 }                                                  // ZONE_TAIL
+};
+
+//******************************************************************************
+//******************************************************************************
+//  PATTERNS
+//******************************************************************************
+//******************************************************************************
+
+
+// Every zone runs its own pattern instance (zoneInstances[]) in the same
+// frame, each at its own phase.
+//
+// PSUEDO:
+//  1. Each zone draws itself.
+//  2. Show them all together.
+//  3. Move each zone's phase on by its speed, once for every frame that went by.
+void matrixZones(struct WS2812B_Strip *strip, const uint8_t delayTime)
+{
+  struct ZoneInstance *instance;
+  uint16_t j, advance;
+  uint8_t zone;
+
+  clear(strip);
+  show(strip);
+
+  frameBegin(strip, delayTime);
+  for (j = 0; j < 256; j += advance)
+  {
+    if (strip->breakFromPattern == true)
+    {
+      return;
+    }
+
+    //  1. Each zone draws itself.
+    for (zone = 0; zone < NUMBER_OF_ZONES; zone++)
+    {
+      instance = &zoneInstances[zone];
+      if (instance->pattern)
+        instance->pattern(strip, zone, instance);
+    }
+
+    //  2. Show them all together.
+    show(strip);
+
+    //  3. Move each zone's phase on by its speed, once for every frame that went by.
+    advance = frameWait(strip);
+    for (zone = 0; zone < NUMBER_OF_ZONES; zone++)
+    {
+      zoneInstances[zone].phase += (uint8_t)(zoneInstances[zone].speed * advance);
+    }
+  }
+
+  strip->inInterrupt = false;
+  return;
+}
+
+//******************************************************************************
+//******************************************************************************
+//  ZONE PATTERNS
+//******************************************************************************
+//******************************************************************************
+
+
+// Hue from the sum of a horizontal and a vertical sine wave.  2D, so it
+// draws the matrix through matrixIndex(), clipped to 'zone': on a zone
+// off the matrix it draws nothing.
+void zonePlasma(struct WS2812B_Strip *strip, uint8_t zone, const struct ZoneInstance *instance)
+{
+  uint16_t first = zones[zone].first;
+  uint8_t x, y, level, phase = instance->phase;
+
+  for (y = 0; y < MATRIX_LOGICAL_HEIGHT; y++)
+  {
+    for (x = 0; x < MATRIX_LOGICAL_WIDTH; x++)
+    {
+      level = (sin8((x << 5) + phase) >> 1) + (sin8((y << 6) + (phase << 1)) >> 1);
+      // Before the zone wraps to past its end, which setZonePixelColor() drops.
+      setZonePixelColor(strip, zone, matrixIndex(x, y) - first, hsv(level + phase, 255, 255));
+    }
+  }
+}
+
+
+// The color wheel, 16 hues a pixel, turning with the phase.
+void zoneRainbow(struct WS2812B_Strip *strip, uint8_t zone, const struct ZoneInstance *instance)
+{
+  uint16_t pixelIndex;
+
+  for (pixelIndex = 0; pixelIndex < zones[zone].count; pixelIndex++)
+  {
+    setZonePixelColor(strip, zone, pixelIndex, hsv((pixelIndex << 4) + instance->phase, 255, 255));
+  }
+}
+
+
+// The whole zone in the instance's color.
+void zoneSolid(struct WS2812B_Strip *strip, uint8_t zone, const struct ZoneInstance *instance)
+{
+  uint16_t pixelIndex;
+
+  for (pixelIndex = 0; pixelIndex < zones[zone].count; pixelIndex++)
+  {
+    setZonePixelColor(strip, zone, pixelIndex, instance->color);
+  }
+}
+
+//******************************************************************************
+//******************************************************************************
+//   MATRIX HELPER FUNCTIONS
+//******************************************************************************
+//******************************************************************************
+
+// Strip index of picture pixel (x, y), (0, 0) top left after rotation.
+// Off the picture gives an index setPixelColor() ignores.
+uint16_t matrixIndex(uint8_t x, uint8_t y)
+{
+  if ((x >= MATRIX_LOGICAL_WIDTH) || (y >= MATRIX_LOGICAL_HEIGHT))
+    return 0xFFFF;
+
+  return matrixTable[matrixRowStart[y] + x];
+}
+
+
+// setPixelColor() for pixel 'index' of 'zone'.  Past the end of the zone
+// is ignored, so a pattern cannot spill into the next one.
+void setZonePixelColor(struct WS2812B_Strip *strip, uint8_t zone, uint16_t index, uint32_t color)
+{
+  if (index < zones[zone].count)
+    setPixelColor(strip, zones[zone].first + index, color);
+}
+
+
+// Start 'zone' on a new pattern instance from phase 0.  The next frame of
+// matrixZones() picks it up.
+void setZonePattern(uint8_t zone, ZonePattern pattern, uint32_t color, uint8_t speed)
+{
+  zoneInstances[zone].pattern = pattern;
+  zoneInstances[zone].color = color;
+  zoneInstances[zone].speed = speed;
+  zoneInstances[zone].phase = 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * matrix.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ */
+
+#ifndef MATRIX_H_
+#define MATRIX_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "WS2812B_Strip.h"
+
+// Wiring of the rows, pick one for MATRIX_LAYOUT.
+#define MATRIX_PROGRESSIVE 0   // Every row runs left to right.
+#define MATRIX_SERPENTINE  1   // Rows alternate direction (zig-zag.)
+
+// The matrix as wired: MATRIX_WIDTH pixels per row, starting at strip pixel
+// MATRIX_FIRST_PIXEL with the top left corner.  Up to 511 pixels.
+#define MATRIX_FIRST_PIXEL 0
+#define MATRIX_WIDTH       8
+#define MATRIX_HEIGHT      4
+#ifndef MATRIX_LAYOUT
+#define MATRIX_LAYOUT      MATRIX_SERPENTINE
+#endif
+#ifndef MATRIX_ROTATION
+#define MATRIX_ROTATION    0   // Quarter turns clockwise of the picture, 0-3.
+#endif
+
+#define MATRIX_PIXELS      (MATRIX_WIDTH * MATRIX_HEIGHT)
+
+// Size of the picture patterns draw, after MATRIX_ROTATION.
+#if MATRIX_ROTATION & 1
+#define MATRIX_LOGICAL_WIDTH   MATRIX_HEIGHT
+#define MATRIX_LOGICAL_HEIGHT  MATRIX_WIDTH
+#else
+#define MATRIX_LOGICAL_WIDTH   MATRIX_WIDTH
+#define MATRIX_LOGICAL_HEIGHT  MATRIX_HEIGHT
+#endif
+
+// Named runs of pixels on the one data line.  Each can run its own pattern.
+struct Zone {
+  uint16_t first;  // Strip index of the zone's first pixel.
+  uint16_t count;
+};
+
+#define NUMBER_OF_ZONES  2
+#define ZONE_MATRIX      0   // The matrix above.
+#define ZONE_TAIL        1   // Whatever is left of the strip after it.
+
+extern const struct Zone zones[NUMBER_OF_ZONES];
+
+// What a zone is running.  matrixZones() calls 'pattern' once a frame to
+// draw just that zone, and moves 'phase' on by 'speed' every frame, so two
+// zones can run the same pattern at their own pace and color.
+struct ZoneInstance;
+typedef void (*ZonePattern)(struct WS2812B_Strip *strip, uint8_t zone, const struct ZoneInstance *instance);
+
+struct ZoneInstance {
+  ZonePattern pattern;
+  uint32_t color;   // For the patterns that take one.
+  uint8_t  speed;   // Phase per frame, 255 = 1 backwards.
+  uint8_t  phase;
+};
+
+extern struct ZoneInstance zoneInstances[NUMBER_OF_ZONES];
+
+// Callable Patterns.
+void matrixZones(struct WS2812B_Strip *strip, const uint8_t delayTime);
+
+// Zone Patterns, for setZonePattern().
+void zonePlasma(struct WS2812B_Strip *strip, uint8_t zone, const struct ZoneInstance *instance);
+void zoneRainbow(struct WS2812B_Strip *strip, uint8_t zone, const struct ZoneInstance *instance);
+void zoneSolid(struct WS2812B_Strip *strip, uint8_t zone, const struct ZoneInstance *instance);
+
+// Matrix helper functions
+uint16_t matrixIndex(uint8_t x, uint8_t y);
+void setZonePixelColor(struct WS2812B_Strip *strip, uint8_t zone, uint16_t index, uint32_t color);
+void setZonePattern(uint8_t zone, ZonePattern pattern, uint32_t color, uint8_t speed);
+
+#endif /* MATRIX_H_ */
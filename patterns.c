@@ -7,6 +7,28 @@
 
 
 #include "patterns.h"
+#include "colormath.h"
+#include "animation.h"
+
+// Rising half of a breath: a raised cosine, gamma corrected (2.2) so it
+// looks smooth to the eye instead of rushing through the dim end.
+// 255 * ((1 - cos(pi * i / 127)) / 2)^2.2
+static const uint8_t breatheCurve[BREATHE_STEPS] = {
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   2,   2,   2,   3,   3,   3,
+    4,   4,   5,   6,   6,   7,   8,   9,  10,  11,  12,  13,  14,  15,  17,  18,
+   20,  21,  23,  25,  27,  29,  31,  33,  35,  38,  40,  43,  45,  48,  51,  54,
+   57,  60,  63,  67,  70,  73,  77,  81,  84,  88,  92,  96, 100, 104, 108, 112,
+  116, 120, 124, 128, 133, 137, 141, 145, 150, 154, 158, 162, 167, 171, 175, 179,
+  183, 187, 191, 195, 199, 202, 206, 209, 213, 216, 219, 223, 226, 228, 231, 234,
+  236, 239, 241, 243, 245, 247, 248, 250, 251, 252, 253, 254, 254, 255, 255, 255
+};
+
+// Both policeLights() frames: blit from [0] for red first, [1] for blue.
+static const uint32_t policeColors[3] = { RED, BLUE, RED };
+
+static uint8_t breatheStep(uint16_t progress);
+static void breatheFrame(struct WS2812B_Strip *strip, uint32_t color, uint8_t level);
 
 //******************************************************************************
 //******************************************************************************
@@ -29,120 +51,165 @@ void testColor(struct WS2812B_Strip *strip, const uint8_t red, const uint8_t gre
 
 
 // Fill the dots one after the other with a color, like wiping a paint bursh
-//  delayTime is the number of ms between each pixel being lit.
+//  delayTime is the time in ms for the whole wipe.
+//
+// How far the wipe has got comes from the time since it started, not from
+// counting pixels, so it takes delayTime however long the strip is (no
+// delayTime/NUMBER_OF_PIXELS rounding to 0ms) and however slow show() is.
 void colorWipe(struct WS2812B_Strip *strip, const uint32_t color, const uint32_t delayTime)
 {
-  uint16_t pixelIndex;
+  static struct Animation wipe;
+  uint16_t lit = 0, target, progress;
 
-  for(pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex++)
+  animationBegin(&wipe, delayTime);
+  frameBegin(strip, ANIMATION_FRAME_MS);
+  while (lit < strip->numberOfPixels)
   {
 	if (strip->breakFromPattern == true)
 	{
 	  return;
 	}
 
-  	setPixelColor(strip, pixelIndex, color);
+    // Light every pixel that should be lit by now.
+    progress = animationProgress(&wipe);
+    if (progress == 0xFFFF)
+      target = strip->numberOfPixels;
+    else
+      target = ((uint32_t)progress * strip->numberOfPixels) >> 16;
+    fillPixels(strip, lit, target - lit, color);
+    lit = target;
+
     show(strip);
-    delay_ms(delayTime/NUMBER_OF_PIXELS);
+    frameWait(strip);
   }
   return;
 }
 
 void fillStripWithSolidColor(struct WS2812B_Strip *strip, const uint32_t color)
 {
-  uint16_t pixelIndex;
-
-  for(pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex++)
-  {
-	setPixelColor(strip, pixelIndex, color);
-  }
+  fillPixels(strip, 0, strip->numberOfPixels, color);
   show(strip);
   return;
 }
 
 void policeLights(struct WS2812B_Strip * strip, const uint32_t delayTime)
 {
-  // Flash every other pixel: RED,BLUE,RED,BLUE ... BLUE,RED,BLUE,RED ...
-  uint16_t i;
+  uint16_t j;
 
-  for (i = 0; i < strip->numberOfPixels; i += 2)
-  {
-    setPixelColor(strip, i, RED);
-  }
-  for (i = 1; i < strip->numberOfPixels; i += 2)
+  // Flash every other pixel: RED,BLUE,RED,BLUE ... BLUE,RED,BLUE,RED ...
+  // Paced by frameWait() (not delay_ms()) so synced boards flash together.
+  frameBegin(strip, delayTime);
+  for (j = 0; j < 2; j += frameWait(strip))
   {
-    setPixelColor(strip, i, BLUE);
-  }
-  show(strip);
-  delay_ms(delayTime);
+    if (strip->breakFromPattern == true)
+      return;
 
-  for (i = 0; i < strip->numberOfPixels; i += 2)
-  {
-    setPixelColor(strip, i, BLUE);
-  }
-  for (i = 1; i < strip->numberOfPixels; i +=2)
-  {
-    setPixelColor(strip, i, RED);
+    blitPixels(strip, 0, strip->numberOfPixels, &policeColors[j], 2);
+    show(strip);
   }
-  show(strip);
-  delay_ms(delayTime);
 
   strip->inInterrupt = false;
   return;
 }
 
+// Each frame is the last one rotated towards pixel 0 plus new pixels at
+// the far end, so only those are drawn: rotatePixels() moves the rest for
+// free.  Same output as drawing hue pixelIndex + j on every pixel.
+//
+// j comes from the time since the cycle started (animation.c), one hue
+// per delayTime, so the rainbow turns at the same speed however many
+// frames get dropped; a late frame just rotates further.
 void rainbow(struct WS2812B_Strip *strip, const uint8_t delayTime)
 {
-  uint16_t pixelIndex, j;
+  static struct Animation cycle;
+  uint16_t pixelIndex, j, next, advance;
 
   clear(strip);
   show(strip);
 
-  for(j = 0; j < 256; j++)
+  for(pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex++)
+  {
+    setPixelColor(strip, pixelIndex, hsv(pixelIndex, 255, 255));
+  }
+
+  animationBegin(&cycle, 256UL * delayTime);
+  frameBegin(strip, delayTime);
+  for(j = 0; ; j = next)
   {
 	if (strip->breakFromPattern == true)
 	{
+	  strip->ringOffset = 0;
 	  return;
 	}
 
-	for(pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex++)
+    show(strip);
+    frameWait(strip);
+    if (animationDone(&cycle) == true)
+      break;
+
+    // Next frame: the hue the cycle is at by now (to the nearest), rotate by
+    // how far that is on, draw the new end pixels.
+    next = ((uint32_t)animationPhase(&cycle) + 0x80) >> 8;
+    advance = next - j;
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_HALF
+    // No rotatePixels() on pixel pairs, redraw every pixel if it moved.
+    for(pixelIndex = 0; (advance != 0) && (pixelIndex < strip->numberOfPixels); pixelIndex++)
     {
-      setPixelColor(strip, pixelIndex, Wheel((pixelIndex+j) & 255));
+      setPixelColor(strip, pixelIndex, hsv(pixelIndex + next, 255, 255));
     }
-
-    show(strip);
-    delay_ms(delayTime);
+#else
+    rotatePixels(strip, advance);
+    pixelIndex = 0;
+    if (advance < strip->numberOfPixels)
+      pixelIndex = strip->numberOfPixels - advance;
+    for(; pixelIndex < strip->numberOfPixels; pixelIndex++)
+    {
+      setPixelColor(strip, ringIndex(strip, pixelIndex), hsv(pixelIndex + next, 255, 255));
+    }
+#endif
   }
 
+  strip->ringOffset = 0;
   strip->inInterrupt = false;
   return;
 }
 
 
 // Slightly different, this makes the rainbow equally distributed throughout
+//
+// The hue steps 256/numberOfPixels per pixel, kept in 8.8 fixed point so
+// the divide is done once per call instead of once per pixel.  32 bits,
+// a single pixel's step is the whole 0x10000.
 void rainbowCycle(struct WS2812B_Strip *strip, const uint8_t delayTime)
 {
   uint16_t j;
   uint16_t pixelIndex;
+  uint32_t hue, hueStep;
+
+  if (strip->numberOfPixels == 0)
+    return;
+  hueStep = 0x10000UL / strip->numberOfPixels;
 
   clear(strip);
   show(strip);
 
   // cycles of all colors on wheel
-  for(j = 0; j < 256; j++)
+  frameBegin(strip, delayTime);
+  for(j = 0; j < 256; j += frameWait(strip))
   {
 	if (strip->breakFromPattern == true)
 	{
 	  return;
 	}
 
+	hue = (uint32_t)j << 8;
 	for(pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex++)
     {
-      setPixelColor(strip, pixelIndex, Wheel(((pixelIndex * 256 / strip->numberOfPixels) + j) & 255));
+      setPixelColor(strip, pixelIndex, hsv((uint8_t)(hue >> 8), 255, 255));
+      hue += hueStep;
     }
 
 	show(strip);
-    delay_ms(delayTime);
   }
 
   strip->inInterrupt = false;
@@ -151,36 +218,50 @@ void rainbowCycle(struct WS2812B_Strip *strip, const uint8_t delayTime)
 
 
 //Theatre-style crawling lights.
+// Every third pixel is lit once, then each frame rotates the strip one
+// pixel away from pixel 0 and only redraws pixel 0 (whatever came round
+// from the far end does not fit the pattern unless the strip is a
+// multiple of 3 long.)  Half resolution redraws the strip every frame.
 void theaterChase(struct WS2812B_Strip *strip, uint32_t c, const uint8_t delayTime)
 {
-  uint16_t pixelIndex, j;
+  uint16_t q, step, advance;
+  uint8_t phase = 0;  // q % 3
 
   clear(strip);
   show(strip);
 
-  for (pixelIndex = 0; pixelIndex < 3; pixelIndex++)
+  fillPixelsStrided(strip, 0, 3, c);
+
+  frameBegin(strip, delayTime);
+  for (q = 0; q < 3; q += advance)
   {
 	if (strip->breakFromPattern == true)
 	{
+	  strip->ringOffset = 0;
 	  return;
 	}
 
-    // Turn every third pixel on
-    for (j = 0; j < strip->numberOfPixels; j += 3)
-    {
-      setPixelColor(strip, pixelIndex + j, c);
-    }
-
     show(strip);
-    delay_ms(delayTime);
+    advance = frameWait(strip);
 
-    // Turn every third pixel off
-    for (j = 0; j < strip->numberOfPixels; j += 3)
+    // Next frame(s): pixel 0 is lit every third step.
+    for (step = advance; step != 0; step--)
     {
-      setPixelColor(strip, pixelIndex + j, 0);
+      if (++phase == 3)
+        phase = 0;
+#if FRAMEBUFFER_MODE != FRAMEBUFFER_HALF
+      rotatePixels(strip, strip->numberOfPixels - 1);
+      setPixelColor(strip, ringIndex(strip, 0), (phase == 0) ? c : 0);
+#endif
     }
+#if FRAMEBUFFER_MODE == FRAMEBUFFER_HALF
+    // No rotatePixels() on pixel pairs: redraw, every third from 'phase'.
+    fillPixels(strip, 0, strip->numberOfPixels, 0);
+    fillPixelsStrided(strip, phase, 3, c);
+#endif
   }
 
+  strip->ringOffset = 0;
   strip->inInterrupt = false;
   return;
 }
@@ -196,6 +277,7 @@ void theaterChaseRainbow(struct WS2812B_Strip *strip, const uint8_t delayTime)
   clear(strip);
   show(strip);
 
+  frameBegin(strip, delayTime);
   for (j = 0; j < 256; j += 4)
   {
 	if (strip->breakFromPattern == true)
@@ -203,21 +285,17 @@ void theaterChaseRainbow(struct WS2812B_Strip *strip, const uint8_t delayTime)
 	  return;
 	}
 
-    for (q = 0; q < 3; q++)
+    for (q = 0; q < 3; q += frameWait(strip))
     {
       //turn every third pixel on
       for (pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex += 3)
       {
-    	setPixelColor(strip, pixelIndex+q, Wheel( (pixelIndex+j) % 255));
+    	setPixelColor(strip, pixelIndex+q, hsv(pixelIndex + j, 255, 255));
       }
       show(strip);
-      delay_ms(delayTime);
 
       //turn every third pixel off
-      for (pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex += 3)
-      {
-    	setPixelColor(strip, pixelIndex+q, 0);
-      }
+      fillPixelsStrided(strip, q, 3, 0);
     }
   }
 
@@ -226,54 +304,61 @@ void theaterChaseRainbow(struct WS2812B_Strip *strip, const uint8_t delayTime)
 }
 
 
-// Breath a color, for a total breathe time of...
+// Breath a color, for a total breathe time of breathCycleTime, plus a
+// breathCycleTime/16 pause at the top and bottom.
+//
+// Every frame is scaled from 'color' itself through breatheCurve[] (see
+// breatheFrame()), rather than rescaling the last frame with
+// setBrightness(), so there is no rounding build up: the top of the breath is exactly 'color' again (see
+// host/test_breathe.c) and strip->brightness is left alone.  Where we are
+// on the curve comes from the time since the breath started (animation.c),
+// each half and pause chained on from the end of the last, so a slow or
+// dropped frame doesn't slow the breath down.  Frames are paced in
+// timebase ticks, one per breatheCurve[] entry when nothing is late.
 void breathe(struct WS2812B_Strip *strip, uint32_t color, const uint32_t breathCycleTime)
 {
-  uint8_t oldBrightness = strip->brightness;
-  uint16_t pixelIndex;
-  uint8_t j;
+  static struct Animation breath;
 
   clear(strip);
   show(strip);
 
-  for (pixelIndex = 0; pixelIndex < strip->numberOfPixels; pixelIndex++)
-  {
-    setPixelColor(strip, pixelIndex, color);
-  }
-
   // Breathe in.
-  for(j = 1; j < 255; j++)
+  animationBegin(&breath, breathCycleTime / 2);
+  frameBeginTicks(strip, (breathCycleTime * (TIMEBASE_TICKS_PER_MS / 2)) / BREATHE_STEPS);
+  while (animationDone(&breath) == false)
   {
 	if (strip->breakFromPattern == true)
 	{
 	  return;
 	}
 
-	setBrightness(strip, j);
-    show(strip);
-	delay_ms(breathCycleTime/512);
+    breatheFrame(strip, color, breatheCurve[breatheStep(animationProgress(&breath))]);
+    frameWait(strip);
   }
 
-  // pause in.
-  delay_ms(breathCycleTime/16);
+  // pause in.  (Top of the breath, whichever frame was last.)
+  animationNext(&breath, breathCycleTime / 16);
+  fillStripWithSolidColor(strip, color);
+  delayUntil(animationEnd(&breath));
 
   // Breathe out.
-  for(j = 255; j > 0; j--)
+  animationNext(&breath, breathCycleTime / 2);
+  frameBeginTicks(strip, (breathCycleTime * (TIMEBASE_TICKS_PER_MS / 2)) / BREATHE_STEPS);
+  while (animationDone(&breath) == false)
   {
 	if (strip->breakFromPattern == true)
 	{
 	  return;
 	}
 
-    setBrightness(strip, j);
-    show(strip);
-	delay_ms(breathCycleTime/512);
+    breatheFrame(strip, color, breatheCurve[BREATHE_STEPS - 1 - breatheStep(animationProgress(&breath))]);
+    frameWait(strip);
   }
 
   // pause out.
-  delay_ms(breathCycleTime/16);
+  animationNext(&breath, breathCycleTime / 16);
+  delayUntil(animationEnd(&breath));
 
-  strip->brightness = oldBrightness;
   return;
 }
 
@@ -283,6 +368,40 @@ void breathe(struct WS2812B_Strip *strip, uint32_t color, const uint32_t breathC
 //******************************************************************************
 //******************************************************************************
 
+// Which breatheCurve[] entry (the easing) a half breath is at, from its
+// animationProgress().  Rounded to the nearest, so a frame that lands right
+// on its deadline gets its own entry and not the one before.
+static uint8_t breatheStep(uint16_t progress)
+{
+  uint16_t step = ((uint32_t)progress + (0x8000 / BREATHE_STEPS)) / (0x10000 / BREATHE_STEPS);
+
+  if (step >= BREATHE_STEPS)
+    step = BREATHE_STEPS - 1;
+  return (uint8_t)step;
+}
+
+
+// Show one breathe() frame, 'color' at breatheCurve[] 'level'.
+// strip->brightness is folded into the color once (storedColor()), and
+// again only if the color or the brightness (IR, I2C) changes, so a frame
+// is three scale8()s and a fillPixelsStored(), no brightness multiplies.
+// Level 255 is exactly fillStripWithSolidColor(color).
+static void breatheFrame(struct WS2812B_Strip *strip, uint32_t color, uint8_t level)
+{
+  static uint32_t litColor, lit;
+  static uint8_t litBrightness;
+
+  if ((color != litColor) || (strip->brightness != litBrightness))
+  {
+    litColor = color;
+    litBrightness = strip->brightness;
+    lit = storedColor(strip, color);
+  }
+  fillPixelsStored(strip, 0, strip->numberOfPixels, scaleColor(lit, level));
+  show(strip);
+}
+
+
 // Convert separate R,G,B into packed 32-bit RGB color.
 // Packed format is always RGB, regardless of LED strand color order.
 uint32_t color(uint8_t r, uint8_t g, uint8_t b)
@@ -291,8 +410,20 @@ uint32_t color(uint8_t r, uint8_t g, uint8_t b)
 }
 
 
+// Scale packed color 'c' by level/255 on each channel.  level 255 returns
+// 'c' unchanged.  Independent of strip->brightness, which setPixelColor()
+// still applies on top.
+uint32_t scaleColor(uint32_t c, uint8_t level)
+{
+  return color(scale8((uint8_t)(c >> 16), level),
+               scale8((uint8_t)(c >>  8), level),
+               scale8((uint8_t)(c), level));
+}
+
+
 // Input a value 0 to 255 to get a color value.
 // The colours are a transition r - g - b - back to r.
+// Kept for old callers, the patterns use hsv() (colormath.c) instead.
 uint32_t Wheel(uint8_t wheelPosition) {
   wheelPosition = 255 - wheelPosition;
   if(wheelPosition < 85)
@@ -11,6 +11,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "WS2812B_Strip.h"
+#include "scheduler.h"
+
+#define BREATHE_STEPS 128  // Frames per half breath, see breatheCurve[]
 
 // Callable Patterns.
 void testColor(struct WS2812B_Strip *strip, const uint8_t red, const uint8_t green,const uint8_t blue, const uint32_t delayTime);
@@ -25,6 +28,7 @@ void breathe(struct WS2812B_Strip *strip, uint32_t color, const uint32_t delayTi
 
 // Pattern helper functions
 uint32_t color(uint8_t r, uint8_t g, uint8_t b);
+uint32_t scaleColor(uint32_t c, uint8_t level);
 uint32_t Wheel(uint8_t WheelPososition);
 inline void returnIfInISR(struct WS2812B_Strip *strip);
 
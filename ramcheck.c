@@ -0,0 +1,88 @@
+/*
+ * ramcheck.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * Stack high water mark and free RAM at run time.
+ *
+ * All 1kiB of RAM is shared: the strip buffers and everything else static
+ * sit at the bottom, the stack grows down from the top (.stack is HIGH in
+ * lnk_msp430f2272.cmd.)  The 80 byte --stack_size only reserves space, it
+ * does not stop the stack growing past it into the statics, and nothing
+ * tells us when it does.  So:
+ *
+ *  - ramPaint() (main() step 1.9, after the peripherals are set up and
+ *    before interrupts are on) fills every byte between the end of the
+ *    statics and the stack pointer with RAM_PAINT.  Whatever stack the
+ *    set up used before that is not counted, it is all returned by then.
+ *  - ramCheck() scans up from the end of the statics for the first word
+ *    that is not RAM_PAINT.  That is the deepest the stack has ever been,
+ *    whichever ISRs happened to nest on top of whatever pattern was running.
+ *
+ * The numbers are read over I2C (I2C_REG_RAM_STATIC_LOW on, see i2c.h),
+ * which runs ramCheck() for a fresh measurement, and a pattern change
+ * flashes the status LED three times as long once headroom is under
+ * RAM_LOW_WARNING.
+ *
+ * The linker gives us both ends: __RAM_STATIC_END from the GROUP in
+ * lnk_msp430f2272.cmd, and the usual __STACK_END.
+ *
+ * WORST CASE NESTING:
+ *  Port_1 is the only ISR that turns interrupts back on, when a long press
+ *  puts us to sleep inside it.  So the deepest path is a pattern inside
+ *  show() or frameWait(), then Port_1 asleep, then one more ISR on top:
+ *  Port_2 (a follower receiving a sync packet), Timer_B, or Port_1 again
+ *  for the press that wakes us.  None of those nest any further.
+ *  host/test_ramcheck.c runs that path; on a board, do a long press, wake
+ *  it with a short one and read the headroom before trusting a new
+ *  NUMBER_OF_PIXELS.
+ */
+
+#include <msp430f2272.h>
+#include "ramcheck.h"
+
+extern uint16_t __RAM_STATIC_END;  // Linker: end of .bss/.data/.sysmem.
+extern uint16_t __STACK_END;       // Linker: top of RAM, where SP starts.
+
+struct RamUsage ramUsage;
+
+
+// Paint everything below the stack pointer down to the statics.  Call with
+// interrupts off, before anything else has used much stack.
+void ramPaint(void)
+{
+  uint16_t *ptr = (uint16_t *)(((uintptr_t)&__RAM_STATIC_END + 1) & ~(uintptr_t)1);
+  uint16_t *stackPointer = (uint16_t *)__get_SP_register();
+
+  while (ptr < stackPointer)
+  {
+    *ptr++ = RAM_PAINT;
+  }
+}
+
+
+// Measure how much of the painted RAM has been touched.
+//
+// PSUEDO:
+//  1. Statics are fixed, straight from the linker symbols.
+//  2. Walk up from the statics to the first word the stack has overwritten.
+//  3. Everything from there to the top of RAM has been stack at some point.
+void ramCheck(struct RamUsage *usage)
+{
+  uint16_t *ptr = (uint16_t *)(((uintptr_t)&__RAM_STATIC_END + 1) & ~(uintptr_t)1);
+  uint16_t *stackEnd = &__STACK_END;
+
+  //  1. Statics are fixed, straight from the linker symbols.
+  usage->staticBytes = (uintptr_t)&__RAM_STATIC_END - RAM_START;
+
+  //  2. Walk up from the statics to the first word the stack has overwritten.
+  while ((ptr < stackEnd) && (*ptr == RAM_PAINT))
+  {
+    ptr++;
+  }
+
+  //  3. Everything from there to the top of RAM has been stack at some point.
+  usage->headroom = (uintptr_t)ptr - (uintptr_t)&__RAM_STATIC_END;
+  usage->stackPeak = (uintptr_t)stackEnd - (uintptr_t)ptr;
+}
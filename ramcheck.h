@@ -0,0 +1,35 @@
+/*
+ * ramcheck.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ */
+
+#ifndef RAMCHECK_H_
+#define RAMCHECK_H_
+
+#include <stdint.h>
+
+// Free RAM is filled with this at boot, anything else has been stack.
+#ifndef RAM_START
+#define RAM_START        0x0200  // MSP430F2272 RAM, see lnk_msp430f2272.cmd
+#endif
+#define RAM_PAINT        0xCDCD
+
+// Warn on the status LED when the deepest the stack has ever been leaves
+// fewer than this many bytes above .bss/.data/.sysmem.
+#define RAM_LOW_WARNING  16
+
+struct RamUsage {
+  uint16_t staticBytes;  // .bss + .data + .TI.noinit + .sysmem
+  uint16_t stackPeak;    // Deepest the stack has been since ramPaint().
+  uint16_t headroom;     // Bytes between the two that have never been used.
+};
+
+// Last ramCheck() result, for the debugger's watch window and I2C.
+extern struct RamUsage ramUsage;
+
+void ramPaint(void);
+void ramCheck(struct RamUsage *usage);
+
+#endif /* RAMCHECK_H_ */
@@ -0,0 +1,266 @@
+/*
+ * scheduler.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * Free running timebase and fixed timestep frame pacing.
+ *
+ * Patterns used to do show() then delay_ms(delayTime), so one frame took
+ * render time + show() time + delayTime, and got slower with every pixel
+ * added.  Instead a pattern now calls frameBegin() once, then frameWait()
+ * after each show().  frameWait() sleeps until an absolute deadline on the
+ * timebase, so render and show() time come out of the delay instead of
+ * adding to it.  If we are already past the deadline the miss is counted,
+ * and if we are more than a whole frame behind, those frames are dropped.
+ * frameWait() returns how many frames of animation to step (1 + dropped)
+ * so the animation stays on time either way:
+ *
+ *   frameBegin(strip, delayTime);
+ *   for (j = 0; j < 256; j += frameWait(strip))
+ *   {
+ *     ...render frame j...
+ *     show(strip);
+ *   }
+ *
+ * Boards running the same pattern are kept in step by sync.c: the master
+ * broadcasts each step from frameWait(), followers jump to it, or hold
+ * their frame until the master catches up.  Patterns that don't pace
+ * themselves with frameWait() are not synced, see sync.c.
+ *
+ * show() keeps interrupts off for ~30us per pixel, so the overflow ISR can
+ * be late.  timebaseNow() checks for a pending overflow itself, which is
+ * good for one missed overflow (32.768ms, well over 430 pixels.)
+ */
+
+#include <msp430f2272.h>
+#include "scheduler.h"
+#include "WS2812B_Strip.h"
+#include "sync.h"
+#include "ir.h"
+#include "i2c.h"
+#include "dco.h"
+
+// High 16 bits of the timebase.
+static volatile uint16_t timebaseOverflows;
+
+#if SYNC_ROLE == SYNC_FOLLOWER
+static uint16_t frameSync(struct WS2812B_Strip *strip);
+#endif
+
+
+// Start Timer_B free running: SMCLK/8, continuous mode, overflow interrupt.
+void timebaseInit(void)
+{
+  timebaseOverflows = 0;
+  TBCCTL0 = 0;
+  TBCTL = TBSSEL_2 | ID_3 | MC_2 | TBCLR | TBIE;
+}
+
+
+// Current 32-bit timebase tick (TIMEBASE_TICKS_PER_MS per ms).
+uint32_t timebaseNow(void)
+{
+  uint16_t high, low;
+  uint16_t interruptsOn = __get_SR_register() & GIE;
+
+  __bic_SR_register(GIE);
+  high = timebaseOverflows;
+  low = TBR;
+
+  // Overflow happened but the ISR has not run yet (interrupts off).  The
+  // low half check makes sure 'low' was read after the wrap.
+  if ((TBCTL & TBIFG) && (low < 0x8000))
+    high++;
+
+  if (interruptsOn)
+    __bis_SR_register(GIE);
+
+  return ((uint32_t)high << 16) | low;
+}
+
+
+// Sleep (LPM0) towards 'tick'.  Returns true once 'tick' has been reached,
+// false if we were woken early by any interrupt, so the caller can check its
+// own exit conditions and call again.
+bool timebaseSleepUntil(const uint32_t tick)
+{
+  int32_t remaining;
+
+  __bic_SR_register(GIE);
+  remaining = (int32_t)(tick - timebaseNow());
+  if (remaining <= 0)
+  {
+    __bis_SR_register(GIE);
+    return true;
+  }
+
+  if (remaining < 32)
+  {
+    // Too close to set up a compare safely, just spin it out.
+    __bis_SR_register(GIE);
+    while ((int32_t)(tick - timebaseNow()) > 0)
+    {
+      __no_operation();
+    }
+    return true;
+  }
+
+  // CCR0 only compares the low 16 bits; if the deadline is further than one
+  // overflow away we wake early and the caller comes back.
+  TBCCR0 = (uint16_t)tick;
+  TBCCTL0 = CCIE;
+  __bis_SR_register(LPM0_bits | GIE);  // Timer_B0 ISR (or any other) wakes us.
+
+  return (int32_t)(tick - timebaseNow()) <= 0;
+}
+
+
+// Start pacing frames every 'periodMs' from now.
+void frameBegin(struct WS2812B_Strip *strip, const uint16_t periodMs)
+{
+  frameBeginTicks(strip, (uint32_t)periodMs * TIMEBASE_TICKS_PER_MS);
+}
+
+
+// As frameBegin(), for periods that are not a whole number of ms.
+void frameBeginTicks(struct WS2812B_Strip *strip, const uint32_t periodTicks)
+{
+  strip->frame.period = periodTicks;
+  strip->frame.deadline = timebaseNow() + strip->frame.period;
+  strip->frame.step = 0;
+}
+
+
+// Call after show().  Waits for the current frame's deadline and returns the
+// number of animation steps to advance: 1, or more if frames were dropped.
+//
+// PSUEDO:
+//  0. Follower with a fresh sync packet: start the master's step right now.
+//  1. Late?  Count the miss, drop any whole frames we are behind, no wait.
+//  2. On time: re-trim the DCO if it is due, then sleep until the deadline.
+//  3. Next deadline is one period on from this one (not from now.)
+//  4. Master: tell the followers which step we are starting.
+uint16_t frameWait(struct WS2812B_Strip *strip)
+{
+  struct FrameScheduler *frame = &strip->frame;
+  uint32_t late, dropped;
+  uint16_t advance = 1;
+
+  frame->framesShown++;
+  irPoll(strip);
+  i2cPoll(strip);
+  if (frame->period == 0)
+    return 1;
+
+  //  0. Follower with a fresh sync packet: start the master's step right now.
+#if SYNC_ROLE == SYNC_FOLLOWER
+  if (frame->syncPending)
+    return frameSync(strip);
+#endif
+
+  late = timebaseNow() - frame->deadline;
+
+  //  1. Late?  Count the miss, drop any whole frames we are behind, no wait.
+  if ((int32_t)late >= 0)
+  {
+    frame->deadlinesMissed++;
+    if (late >= frame->period)
+    {
+      dropped = late / frame->period;
+      frame->deadline += dropped * frame->period;
+      frame->framesDropped += (uint16_t)dropped;
+      advance += (uint16_t)dropped;
+    }
+  }
+  //  2. On time: re-trim the DCO if it is due, then sleep until the deadline.
+  else
+  {
+    dcoService(frame->deadline);
+    while ((strip->breakFromPattern == false) && (frame->syncPending == false)
+           && (timebaseSleepUntil(frame->deadline) == false))
+    {
+      irPoll(strip);
+      i2cPoll(strip);
+    }
+
+#if SYNC_ROLE == SYNC_FOLLOWER
+    if (frame->syncPending)
+      return frameSync(strip);
+#endif
+  }
+
+  //  3. Next deadline is one period on from this one (not from now.)
+  frame->deadline += frame->period;
+  frame->step += advance;
+
+  //  4. Master: tell the followers which step we are starting.
+#if SYNC_ROLE == SYNC_MASTER
+  syncBroadcast(strip);
+#endif
+  return advance;
+}
+
+
+#if SYNC_ROLE == SYNC_FOLLOWER
+// The master started frame->syncStep at frame->syncTime, do the same.
+// Ahead of the master: hold this frame (advance 0) until the master gets
+// to our next step, however far ahead we are.  Unless the master is on one
+// of its first SYNC_RESTART_STEPS, then it has started the pattern over
+// (frameBegin()) while we are still on the last run: end ours and start
+// over with it.
+static uint16_t frameSync(struct WS2812B_Strip *strip)
+{
+  struct FrameScheduler *frame = &strip->frame;
+  int16_t advance;
+  uint16_t syncStep;
+
+  __bic_SR_register(GIE);
+  syncStep = frame->syncStep;
+  advance = (int16_t)(syncStep - frame->step);
+  frame->deadline = frame->syncTime + frame->period;
+  frame->syncPending = false;
+  __bis_SR_register(GIE);
+
+  if (advance < 0)
+  {
+    if (syncStep < SYNC_RESTART_STEPS)
+    {
+      strip->breakFromPattern = true;
+      return 1;
+    }
+    frame->deadline += (uint32_t)(-advance) * frame->period;
+    return 0;
+  }
+
+  frame->step += advance;
+  return advance;
+}
+#endif
+
+
+// TimerB CCR0 ISR.  Deadline reached, wake timebaseSleepUntil().
+#pragma vector=TIMERB0_VECTOR
+__interrupt void Timer_B0(void)
+{
+  TBCCTL0 = 0;
+  __bic_SR_register_on_exit(LPM0_bits);
+}
+
+
+// TimerB CCR1-6 and overflow ISR.  IR receiver edges (see ir.c) and
+// extending the timebase to 32 bits.
+#pragma vector=TIMERB1_VECTOR
+__interrupt void Timer_B1(void)
+{
+  switch (TBIV)
+  {
+    case 0x02:  // TBCCR1 capture
+      irCapture();
+      __bic_SR_register_on_exit(LPM0_bits);  // irPoll() decodes it.
+      break;
+    case 0x0E:  // TBIFG
+      timebaseOverflows++;
+      break;
+  }
+}
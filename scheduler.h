@@ -0,0 +1,44 @@
+/*
+ * scheduler.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Timer_B free runs from SMCLK/8 = 2MHz, extended to 32 bits by counting
+// overflows (every 32.768ms).  Wraps after ~35 minutes, which is fine
+// because all comparisons are done on differences.
+#define TIMEBASE_TICKS_PER_MS  2000
+
+struct WS2812B_Strip;
+
+// Absolute deadline frame pacing for one pattern.
+struct FrameScheduler {
+  uint32_t deadline;         // Timebase tick the next frame is due.
+  uint32_t period;           // Timebase ticks per frame.
+  uint16_t framesShown;
+  uint16_t framesDropped;    // Frames skipped to catch up.
+  uint16_t deadlinesMissed;  // Frames that finished after their deadline.
+  uint16_t step;             // Frames since frameBegin() (j for most patterns.)
+
+  // Follower: last packet from the master board, see sync.c
+  uint32_t syncTime;         // Timebase tick it ended (master started drawing.)
+  uint16_t syncStep;         // Step the master was starting.
+  volatile bool syncPending;
+};
+
+void timebaseInit(void);
+uint32_t timebaseNow(void);
+bool timebaseSleepUntil(const uint32_t tick);
+
+void frameBegin(struct WS2812B_Strip *strip, const uint16_t periodMs);
+void frameBeginTicks(struct WS2812B_Strip *strip, const uint32_t periodTicks);
+uint16_t frameWait(struct WS2812B_Strip *strip);
+
+#endif /* SCHEDULER_H_ */
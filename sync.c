@@ -0,0 +1,207 @@
+/*
+ * sync.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ *
+ * Frame sync between several boards on one wire.
+ *
+ * The master sends a SyncPacket at the start of every paced frame (from
+ * frameWait()): header, step, pattern, brightness, checksum.  Followers get
+ * a Hi/Lo edge interrupt on the start bit, read the packet in the Port 2 ISR
+ * and hand it to frameWait(), which starts the same step right away and
+ * takes its next deadline from when the packet ended (which is when the
+ * master starts drawing.)  So the master's frame ticks drive the followers
+ * and their own deadlines only fill in for lost packets.
+ *
+ * By the time the ISR gets to the line, ISR entry and whatever the
+ * compiler put in front of it have already eaten into the 128 cycle
+ * start bit, and by how much depends on what the CPU was doing.  So the
+ * header is not sampled from the ISR's idea of the start edge: bit 0 of
+ * SYNC_HEADER is a 1, its rising edge is exactly one bit after the start
+ * edge, and syncReadHeader() waits for that and samples the rest of the
+ * packet from there, so ISR latency is out of it as long as it is under
+ * a bit.  When the packet ended comes from a TBR read at the checksum's
+ * start edge plus one byte time, so only one byte's worth of baud error
+ * (the master's bit is "~10 cycles for the loop" off nominal) ends up in
+ * the skew between boards, not a whole packet's.
+ *
+ * The wire is bit banged with interrupts off, like show().  A packet that
+ * lands while a follower is inside show() gets mangled, fails the checksum
+ * and is dropped; the next frame's packet fixes things up.
+ *
+ * Only frameWait() sends and follows packets, so patterns that pace
+ * themselves some other way run free on each board: patternRGB (delay_ms()
+ * in main()), audioPulse() (the ADC's blocks) and hostPixels() (the host.)
+ */
+
+#include <msp430f2272.h>
+#include "sync.h"
+#include "main.h"
+
+// Followers read into here from the ISR, it keeps 6 bytes off the stack.
+static uint8_t syncBuffer[6];
+
+static void syncWriteByte(uint8_t byte);
+static bool syncReadHeader(uint8_t *byte);
+static bool syncReadByte(uint8_t *byte, uint16_t *edgeTick);
+static bool syncReadBits(uint8_t value, uint8_t bits, uint8_t *byte);
+
+
+// Set up the sync line for our SYNC_ROLE.
+void syncInit(void)
+{
+#if SYNC_ROLE == SYNC_MASTER
+  SYNC_PORT_OUT |= SYNC_PIN;    // Idle high.
+  SYNC_PORT_DIR |= SYNC_PIN;
+#elif SYNC_ROLE == SYNC_FOLLOWER
+  SYNC_PORT_DIR &= ~SYNC_PIN;
+  SYNC_PORT_REN |= SYNC_PIN;    // Enable internal pull-up resistor.
+  SYNC_PORT_OUT |= SYNC_PIN;
+  SYNC_PORT_IES |= SYNC_PIN;    // Trigger on the Hi/Lo start bit edge.
+  SYNC_PORT_IFG &= ~SYNC_PIN;
+  SYNC_PORT_IE  |= SYNC_PIN;
+#endif
+}
+
+
+// Master: send the step we are about to render, our pattern and brightness.
+// Interrupts are off for the ~480us this takes.
+void syncBroadcast(const struct WS2812B_Strip *strip)
+{
+  uint16_t interruptsOn = __get_SR_register() & GIE;
+  uint8_t stepLow    = (uint8_t)strip->frame.step;
+  uint8_t stepHigh   = (uint8_t)(strip->frame.step >> 8);
+  uint8_t pattern    = (uint8_t)patternState;
+  uint8_t brightness = strip->brightness;
+  uint8_t checksum   = ~(uint8_t)(stepLow + stepHigh + pattern + brightness);
+
+  __bic_SR_register(GIE);
+  syncWriteByte(SYNC_HEADER);
+  syncWriteByte(stepLow);
+  syncWriteByte(stepHigh);
+  syncWriteByte(pattern);
+  syncWriteByte(brightness);
+  syncWriteByte(checksum);
+  if (interruptsOn)
+    __bis_SR_register(GIE);
+}
+
+
+// Follower: read one packet.  Call from the Port 2 ISR first thing, the
+// start bit of the header is already on the line.  Returns false if
+// anything is off, else the packet and the (16-bit) timebase tick it ended
+// on, when the master starts drawing the step.
+bool syncReceive(struct SyncPacket *packet, uint16_t *endTick)
+{
+  uint16_t edgeTick;
+  uint8_t i;
+
+  if (syncReadHeader(&syncBuffer[0]) == false)
+    return false;
+  for (i = 1; i < sizeof(syncBuffer); i++)
+  {
+    if (syncReadByte(&syncBuffer[i], &edgeTick) == false)
+      return false;
+  }
+
+  if (syncBuffer[0] != SYNC_HEADER)
+    return false;
+  if ((uint8_t)~(uint8_t)(syncBuffer[1] + syncBuffer[2] + syncBuffer[3] + syncBuffer[4]) != syncBuffer[5])
+    return false;
+
+  packet->step       = syncBuffer[1] | ((uint16_t)syncBuffer[2] << 8);
+  packet->pattern    = syncBuffer[3];
+  packet->brightness = syncBuffer[4];
+
+  // The checksum's start edge, plus its 10 bits.  Timebase is SMCLK / 8.
+  *endTick = edgeTick + (10 * SYNC_BIT_CYCLES) / 8;
+  return true;
+}
+
+
+// 8N1, LSB first.  The delays leave ~10 cycles for the loop itself; trim
+// them on a scope like show() if the baud rate is off.
+static void syncWriteByte(uint8_t byte)
+{
+  uint8_t bit;
+
+  SYNC_PORT_OUT &= ~SYNC_PIN;                // Start bit.
+  __delay_cycles(SYNC_BIT_CYCLES - 10);
+  for (bit = 8; bit != 0; bit--)
+  {
+    if (byte & 0x01)
+      SYNC_PORT_OUT |= SYNC_PIN;
+    else
+      SYNC_PORT_OUT &= ~SYNC_PIN;
+    byte >>= 1;
+    __delay_cycles(SYNC_BIT_CYCLES - 10);
+  }
+  SYNC_PORT_OUT |= SYNC_PIN;                 // Stop bit.
+  __delay_cycles(SYNC_BIT_CYCLES);
+}
+
+
+// Header, from inside its start bit.
+//
+// PSUEDO:
+//  1. Still in the start bit?  Otherwise we were too late to sync.
+//  2. Wait for bit 0's rising edge, exactly one bit after the start edge.
+//  3. Sample bits 1 - 7 in their middles from there.
+static bool syncReadHeader(uint8_t *byte)
+{
+  uint16_t timeout = SYNC_BIT_CYCLES;
+
+  //  1. Still in the start bit?  Otherwise we were too late to sync.
+  if (SYNC_PORT_IN & SYNC_PIN)
+    return false;
+
+  //  2. Wait for bit 0's rising edge.
+  while ((SYNC_PORT_IN & SYNC_PIN) == 0)
+  {
+    if (--timeout == 0)
+      return false;
+  }
+
+  //  3. Sample bits 1 - 7 in their middles from there.
+  __delay_cycles(SYNC_BIT_CYCLES + (SYNC_BIT_CYCLES / 2) - 10);
+  return syncReadBits(0x80, 7, byte);
+}
+
+
+// PSUEDO:
+//  1. Wait (a few bit times at most) for the start bit, note the tick.
+//  2. Sample each bit in its middle, 1.5 bits after the start edge for bit 0.
+static bool syncReadByte(uint8_t *byte, uint16_t *edgeTick)
+{
+  uint16_t timeout = SYNC_BIT_CYCLES;
+
+  //  1. Wait (a few bit times at most) for the start bit, note the tick.
+  while (SYNC_PORT_IN & SYNC_PIN)
+  {
+    if (--timeout == 0)
+      return false;
+  }
+  *edgeTick = TBR;
+
+  //  2. Sample each bit in its middle, 1.5 bits after the start edge for bit 0.
+  __delay_cycles(SYNC_BIT_CYCLES + (SYNC_BIT_CYCLES / 2) - 10);
+  return syncReadBits(0, 8, byte);
+}
+
+
+// Shift 'bits' more bits into the top of 'value', LSB first, one bit time
+// apart from now.  Then the stop bit must be high.
+static bool syncReadBits(uint8_t value, uint8_t bits, uint8_t *byte)
+{
+  for (; bits != 0; bits--)
+  {
+    value >>= 1;
+    if (SYNC_PORT_IN & SYNC_PIN)
+      value |= 0x80;
+    __delay_cycles(SYNC_BIT_CYCLES - 10);
+  }
+
+  *byte = value;
+  return (SYNC_PORT_IN & SYNC_PIN) != 0;
+}
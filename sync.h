@@ -0,0 +1,54 @@
+/*
+ * sync.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: TWeaK
+ */
+
+#ifndef SYNC_H_
+#define SYNC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "WS2812B_Strip.h"
+
+// One wire, shared by every board: the master drives it, followers listen.
+// (P3.4/P3.5, the USCI_A0 UART pins, are taken by the status LED.)
+#define SYNC_PORT_DIR   P2DIR
+#define SYNC_PORT_OUT   P2OUT
+#define SYNC_PORT_IN    P2IN
+#define SYNC_PORT_REN   P2REN
+#define SYNC_PORT_IE    P2IE
+#define SYNC_PORT_IES   P2IES
+#define SYNC_PORT_IFG   P2IFG
+#define SYNC_PIN        BIT1
+
+// Pick this board's role for SYNC_ROLE.
+#define SYNC_NONE      0
+#define SYNC_MASTER    1
+#define SYNC_FOLLOWER  2
+#ifndef SYNC_ROLE
+#define SYNC_ROLE      SYNC_NONE
+#endif
+
+// Bit banged 8N1, LSB first, idle high.  16MHz / 128 = 125kbaud.  The
+// header's bit 0 must be a 1, followers resync on its rising edge.
+#define SYNC_BIT_CYCLES  128
+#define SYNC_HEADER      0xA5
+
+// A follower ahead of a master on a step below this one takes it that the
+// master has started the pattern over, and starts over too.
+#define SYNC_RESTART_STEPS  4
+
+// What the master sends at the start of every frame.
+struct SyncPacket {
+  uint16_t step;        // Frames since frameBegin() (the pattern's j.)
+  uint8_t  pattern;     // patternState
+  uint8_t  brightness;  // strip->brightness
+};
+
+void syncInit(void);
+void syncBroadcast(const struct WS2812B_Strip *strip);
+bool syncReceive(struct SyncPacket *packet, uint16_t *endTick);
+
+#endif /* SYNC_H_ */